@@ -3,7 +3,8 @@
 #include <QPainter>
 #include <QTextBlock>
 
-CodeEditor::CodeEditor(QWidget *parent) : QPlainTextEdit(parent), isDarkTheme(false), zoomLevel(0)
+CodeEditor::CodeEditor(QWidget *parent) : QPlainTextEdit(parent), isDarkTheme(false), zoomLevel(0),
+    lineNumberOffset(0), maxLineNumberHint(0)
 {
     lineNumberArea = new LineNumberArea(this);
     
@@ -23,7 +24,8 @@ void CodeEditor::setEditorMargins(int left, int top, int right, int bottom)
 int CodeEditor::lineNumberAreaWidth()
 {
     int digits = 1;
-    int max = qMax(1, blockCount());
+    qint64 max = qMax<qint64>(1, blockCount() + qMax<qint64>(0, lineNumberOffset));
+    max = qMax(max, maxLineNumberHint);
     while (max >= 10) {
         max /= 10;
         ++digits;
@@ -34,9 +36,25 @@ int CodeEditor::lineNumberAreaWidth()
     return space;
 }
 
+void CodeEditor::setLineNumberOffset(qint64 offset, qint64 maxLineNumber)
+{
+    if (offset == lineNumberOffset && maxLineNumber == maxLineNumberHint)
+        return;
+
+    lineNumberOffset = offset;
+    maxLineNumberHint = maxLineNumber;
+    updateLineNumberAreaWidth(0);
+    lineNumberArea->update();
+}
+
 void CodeEditor::updateLineNumberAreaWidth(int /* newBlockCount */)
 {
     setEditorMargins(lineNumberAreaWidth(), 0, 0, 0);
+    
+    // Keep the gutter geometry in step with the margin, not just on resize
+    QRect cr = contentsRect();
+    lineNumberArea->setGeometry(QRect(cr.left(), cr.top(), 
+                                      lineNumberAreaWidth(), cr.height()));
 }
 
 void CodeEditor::updateLineNumberArea(const QRect &rect, int dy)
@@ -50,6 +68,20 @@ void CodeEditor::updateLineNumberArea(const QRect &rect, int dy)
         updateLineNumberAreaWidth(0);
 }
 
+int CodeEditor::lastVisibleBlockNumber() const
+{
+    QTextBlock block = firstVisibleBlock();
+    int number = block.blockNumber();
+    int top = qRound(blockBoundingGeometry(block).translated(contentOffset()).top());
+    int height = viewport()->height();
+    while (block.isValid() && top <= height) {
+        number = block.blockNumber();
+        top += qRound(blockBoundingRect(block).height());
+        block = block.next();
+    }
+    return number;
+}
+
 void CodeEditor::resizeEvent(QResizeEvent *e)
 {
     QPlainTextEdit::resizeEvent(e);
@@ -27,6 +27,16 @@ public:
     int getCurrentZoomLevel() const { return zoomLevel; }
     void setZoomLevel(int level);
 
+    // Line numbering for editors that only show a window of a larger file.
+    // offset is the number of lines before the first block (-1 if unknown),
+    // maxLineNumber sizes the gutter so it doesn't jitter while scrolling.
+    void setLineNumberOffset(qint64 offset, qint64 maxLineNumber = 0);
+    qint64 getLineNumberOffset() const { return lineNumberOffset; }
+
+    // Range of blocks that are at least partly inside the viewport
+    int firstVisibleBlockNumber() const { return firstVisibleBlock().blockNumber(); }
+    int lastVisibleBlockNumber() const;
+
 signals:
     void zoomLevelChanged(int zoomLevel); // Add this signal
 
@@ -44,6 +54,8 @@ private:
     int zoomLevel; // Track the current zoom level
     const int DEFAULT_FONT_SIZE = 10; // Default font size in points
     bool isDarkTheme; // Keep track of current theme
+    qint64 lineNumberOffset;
+    qint64 maxLineNumberHint;
 
     friend class LineNumberArea;
 };
@@ -0,0 +1,367 @@
+#include "compressedfile.h"
+#include <climits>
+
+#ifdef NOTEPADX_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef NOTEPADX_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef NOTEPADX_HAVE_LZMA
+#include <lzma.h>
+#endif
+
+// One decoder per format. Each call consumes input and fills output until
+// one of them runs out; inputEnded says that no more input will follow.
+class CompressedFile::Stream
+{
+public:
+    virtual ~Stream() {}
+    virtual bool decompress(const char *&input, size_t &inputLeft, bool inputEnded,
+                            char *&output, size_t &outputLeft, bool &finished) = 0;
+
+    QString errorString;
+};
+
+namespace {
+
+CompressedFile::Format formatOf(const QByteArray &magic)
+{
+    if (magic.startsWith("\x1f\x8b"))
+        return CompressedFile::Gzip;
+    if (magic.startsWith("\x28\xb5\x2f\xfd"))
+        return CompressedFile::Zstd;
+    if (magic.startsWith("\xfd" "7zXZ"))
+        return CompressedFile::Xz;
+    return CompressedFile::None;
+}
+
+#ifdef NOTEPADX_HAVE_ZLIB
+class GzipStream : public CompressedFile::Stream
+{
+public:
+    GzipStream() : m_memberEnded(false)
+    {
+        m_stream.zalloc = Z_NULL;
+        m_stream.zfree = Z_NULL;
+        m_stream.opaque = Z_NULL;
+        m_stream.next_in = Z_NULL;
+        m_stream.avail_in = 0;
+        // 32 on top of the window size selects gzip header detection
+        if (inflateInit2(&m_stream, 15 + 32) != Z_OK)
+            errorString = QStringLiteral("Cannot initialize zlib");
+    }
+
+    ~GzipStream() override
+    {
+        inflateEnd(&m_stream);
+    }
+
+    bool decompress(const char *&input, size_t &inputLeft, bool inputEnded,
+                    char *&output, size_t &outputLeft, bool &finished) override
+    {
+        // Concatenated members are a single file to gzip as well
+        bool startingMember = m_memberEnded;
+        if (m_memberEnded) {
+            if (inputLeft == 0) {
+                finished = inputEnded;
+                return true;
+            }
+            inflateReset(&m_stream);
+            m_memberEnded = false;
+        }
+
+        m_stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input));
+        m_stream.avail_in = static_cast<uInt>(qMin<size_t>(inputLeft, UINT_MAX));
+        m_stream.next_out = reinterpret_cast<Bytef *>(output);
+        m_stream.avail_out = static_cast<uInt>(qMin<size_t>(outputLeft, UINT_MAX));
+        uInt availableIn = m_stream.avail_in;
+        uInt availableOut = m_stream.avail_out;
+        int result = inflate(&m_stream, Z_NO_FLUSH);
+        input += availableIn - m_stream.avail_in;
+        inputLeft -= availableIn - m_stream.avail_in;
+        output += availableOut - m_stream.avail_out;
+        outputLeft -= availableOut - m_stream.avail_out;
+
+        switch (result) {
+        case Z_STREAM_END:
+            m_memberEnded = true;
+            finished = inputLeft == 0 && inputEnded;
+            return true;
+        case Z_OK:
+        case Z_BUF_ERROR:
+            return true;
+        default:
+            // Like gzip itself, ignore padding after the last member
+            if (startingMember) {
+                inputLeft = 0;
+                finished = true;
+                return true;
+            }
+            errorString = m_stream.msg ? QString::fromLatin1(m_stream.msg)
+                                       : QStringLiteral("Corrupt gzip data");
+            return false;
+        }
+    }
+
+private:
+    z_stream m_stream;
+    bool m_memberEnded;
+};
+#endif
+
+#ifdef NOTEPADX_HAVE_ZSTD
+class ZstdStream : public CompressedFile::Stream
+{
+public:
+    ZstdStream() : m_stream(ZSTD_createDStream()), m_frameEnded(false)
+    {
+        if (!m_stream || ZSTD_isError(ZSTD_initDStream(m_stream)))
+            errorString = QStringLiteral("Cannot initialize zstd");
+    }
+
+    ~ZstdStream() override
+    {
+        ZSTD_freeDStream(m_stream);
+    }
+
+    bool decompress(const char *&input, size_t &inputLeft, bool inputEnded,
+                    char *&output, size_t &outputLeft, bool &finished) override
+    {
+        // The last frame may have ended before the reader saw the end of
+        // the file; asking the decoder again would start a new frame
+        if (m_frameEnded && inputLeft == 0) {
+            finished = inputEnded;
+            return true;
+        }
+
+        ZSTD_inBuffer in = { input, inputLeft, 0 };
+        ZSTD_outBuffer out = { output, outputLeft, 0 };
+        size_t result = ZSTD_decompressStream(m_stream, &out, &in);
+        if (ZSTD_isError(result)) {
+            errorString = QString::fromLatin1(ZSTD_getErrorName(result));
+            return false;
+        }
+        input += in.pos;
+        inputLeft -= in.pos;
+        output += out.pos;
+        outputLeft -= out.pos;
+
+        // Zero means a frame was completed and flushed; another may follow
+        m_frameEnded = result == 0;
+        finished = m_frameEnded && inputLeft == 0 && inputEnded;
+        return true;
+    }
+
+private:
+    ZSTD_DStream *m_stream;
+    bool m_frameEnded;
+};
+#endif
+
+#ifdef NOTEPADX_HAVE_LZMA
+class XzStream : public CompressedFile::Stream
+{
+public:
+    XzStream() : m_stream(LZMA_STREAM_INIT)
+    {
+        if (lzma_stream_decoder(&m_stream, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK)
+            errorString = QStringLiteral("Cannot initialize liblzma");
+    }
+
+    ~XzStream() override
+    {
+        lzma_end(&m_stream);
+    }
+
+    bool decompress(const char *&input, size_t &inputLeft, bool inputEnded,
+                    char *&output, size_t &outputLeft, bool &finished) override
+    {
+        m_stream.next_in = reinterpret_cast<const uint8_t *>(input);
+        m_stream.avail_in = inputLeft;
+        m_stream.next_out = reinterpret_cast<uint8_t *>(output);
+        m_stream.avail_out = outputLeft;
+        lzma_ret result = lzma_code(&m_stream, inputEnded ? LZMA_FINISH : LZMA_RUN);
+        input += inputLeft - m_stream.avail_in;
+        inputLeft = m_stream.avail_in;
+        output += outputLeft - m_stream.avail_out;
+        outputLeft = m_stream.avail_out;
+
+        switch (result) {
+        case LZMA_STREAM_END:
+            finished = true;
+            return true;
+        case LZMA_OK:
+        case LZMA_BUF_ERROR:
+            return true;
+        case LZMA_MEM_ERROR:
+            errorString = QStringLiteral("Out of memory");
+            return false;
+        case LZMA_FORMAT_ERROR:
+        case LZMA_OPTIONS_ERROR:
+            errorString = QStringLiteral("Unsupported xz format");
+            return false;
+        default:
+            errorString = QStringLiteral("Corrupt xz data");
+            return false;
+        }
+    }
+
+private:
+    lzma_stream m_stream;
+};
+#endif
+
+CompressedFile::Stream *createStream(CompressedFile::Format format)
+{
+    switch (format) {
+#ifdef NOTEPADX_HAVE_ZLIB
+    case CompressedFile::Gzip:
+        return new GzipStream;
+#endif
+#ifdef NOTEPADX_HAVE_ZSTD
+    case CompressedFile::Zstd:
+        return new ZstdStream;
+#endif
+#ifdef NOTEPADX_HAVE_LZMA
+    case CompressedFile::Xz:
+        return new XzStream;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+} // namespace
+
+CompressedFile::CompressedFile(const QString &fileName, QObject *parent)
+    : QIODevice(parent), m_file(fileName), m_format(None), m_next(nullptr), m_inputLeft(0), m_finished(false)
+{
+}
+
+CompressedFile::~CompressedFile()
+{
+}
+
+CompressedFile::Format CompressedFile::detect(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return None;
+    return formatOf(file.read(6));
+}
+
+bool CompressedFile::isSupported(Format format)
+{
+    switch (format) {
+#ifdef NOTEPADX_HAVE_ZLIB
+    case Gzip:
+        return true;
+#endif
+#ifdef NOTEPADX_HAVE_ZSTD
+    case Zstd:
+        return true;
+#endif
+#ifdef NOTEPADX_HAVE_LZMA
+    case Xz:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+QString CompressedFile::formatName(Format format)
+{
+    switch (format) {
+    case Gzip:
+        return QStringLiteral("gzip");
+    case Zstd:
+        return QStringLiteral("zstd");
+    case Xz:
+        return QStringLiteral("xz");
+    default:
+        return QString();
+    }
+}
+
+bool CompressedFile::open(OpenMode mode)
+{
+    if (mode & WriteOnly) {
+        setErrorString(tr("Compressed files can only be read"));
+        return false;
+    }
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        setErrorString(m_file.errorString());
+        return false;
+    }
+
+    m_format = formatOf(m_file.peek(6));
+    m_stream.reset(createStream(m_format));
+    if (!m_stream || !m_stream->errorString.isEmpty()) {
+        setErrorString(m_stream ? m_stream->errorString : tr("Not a supported compressed file"));
+        m_stream.reset();
+        m_file.close();
+        return false;
+    }
+
+    m_input.clear();
+    m_next = nullptr;
+    m_inputLeft = 0;
+    m_finished = false;
+
+    // The decoder buffers enough already
+    return QIODevice::open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+}
+
+void CompressedFile::close()
+{
+    QIODevice::close();
+    m_stream.reset();
+    m_input.clear();
+    m_inputLeft = 0;
+    m_file.close();
+}
+
+bool CompressedFile::atEnd() const
+{
+    return !isOpen() || m_finished;
+}
+
+qint64 CompressedFile::readData(char *data, qint64 maxSize)
+{
+    char *output = data;
+    size_t outputLeft = static_cast<size_t>(maxSize);
+    while (outputLeft > 0 && !m_finished) {
+        if (m_inputLeft == 0 && !m_file.atEnd()) {
+            m_input = m_file.read(InputChunkSize);
+            if (m_input.isEmpty()) {
+                setErrorString(m_file.errorString());
+                return -1;
+            }
+            m_next = m_input.constData();
+            m_inputLeft = static_cast<size_t>(m_input.size());
+        }
+
+        bool inputEnded = m_inputLeft == 0 && m_file.atEnd();
+        size_t before = outputLeft + m_inputLeft;
+        if (!m_stream->decompress(m_next, m_inputLeft, inputEnded, output, outputLeft, m_finished)) {
+            setErrorString(m_stream->errorString);
+            return -1;
+        }
+
+        // All input was handed over and the decoder still wants more
+        if (!m_finished && inputEnded && outputLeft + m_inputLeft == before) {
+            setErrorString(tr("The compressed data is truncated"));
+            return -1;
+        }
+    }
+    return maxSize - static_cast<qint64>(outputLeft);
+}
+
+qint64 CompressedFile::writeData(const char *data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
@@ -0,0 +1,62 @@
+#ifndef COMPRESSEDFILE_H
+#define COMPRESSEDFILE_H
+
+#include <QIODevice>
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+#include <memory>
+
+// Sequential read-only device that decompresses a gzip, zstd or xz file as
+// it is read, so compressed files can go through the normal loader without
+// being inflated to disk or held in memory compressed and uncompressed at
+// the same time. Which formats are available depends on the libraries
+// found at build time.
+class CompressedFile : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    enum Format {
+        None,
+        Gzip,
+        Zstd,
+        Xz
+    };
+
+    explicit CompressedFile(const QString &fileName, QObject *parent = nullptr);
+    ~CompressedFile();
+
+    // Looks at the magic bytes only; the file extension is not trusted
+    static Format detect(const QString &fileName);
+    static bool isSupported(Format format);
+    static QString formatName(Format format);
+
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override { return true; }
+    bool atEnd() const override;
+
+    // Progress is measured on the compressed input
+    qint64 compressedPos() const { return m_file.pos() - static_cast<qint64>(m_inputLeft); }
+    qint64 compressedSize() const { return m_file.size(); }
+
+    class Stream;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    QFile m_file;
+    Format m_format;
+    std::unique_ptr<Stream> m_stream;
+    QByteArray m_input;
+    const char *m_next;
+    size_t m_inputLeft;
+    bool m_finished;
+
+    static const int InputChunkSize = 256 * 1024;
+};
+
+#endif // COMPRESSEDFILE_H
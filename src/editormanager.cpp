@@ -2,6 +2,8 @@
 #include "mainwindow.h"
 #include "editorwidget.h"
 #include "codeeditor.h"
+#include "hexview.h"
+#include "svgiconprovider.h"
 #include "fileoperations.h"
 #include "highlighting/highlighterfactory.h"
 #include <QTabWidget>
@@ -29,12 +31,14 @@ EditorManager::EditorManager(MainWindow *parent)
     m_languageActionGroup = nullptr;
     m_themeActionGroup = nullptr;
     m_wordWrapAction = nullptr;
+    m_followAction = nullptr;
     
     // Get status bar labels directly from MainWindow using the getter methods
     m_lineColumnLabel = parent->getLineColumnLabel();
     m_modifiedLabel = parent->getModifiedLabel();
     m_filenameLabel = parent->getFilenameLabel();
     m_zoomLabel = parent->getZoomLabel();
+    m_lineEndingLabel = parent->getLineEndingLabel();
     
     // Initialize member variables with values from MainWindow
     m_tabWidget = parent->findChild<QTabWidget*>();
@@ -71,6 +75,13 @@ EditorManager::EditorManager(MainWindow *parent)
         }
     }
     
+    for (QAction* action : parent->findChildren<QAction*>()) {
+        if (action->text() == "&Follow File" && action->isCheckable()) {
+            m_followAction = action;
+            break;
+        }
+    }
+    
     // Synchronize the word wrap checkbox with the loaded setting
     if (m_wordWrapAction) {
         m_wordWrapAction->setChecked(m_isWordWrapEnabled);
@@ -124,32 +135,7 @@ void EditorManager::applyLightTheme()
     }
     
     // Set toolbar icons to appropriate color for light theme
-    QList<QAction *> actions = m_mainWindow->findChildren<QAction *>();
-    for (QAction *action : actions) {
-        if (action->icon().isNull())
-            continue;
-
-        QIcon originalIcon = action->icon();
-        QIcon::Mode mode = QIcon::Normal;
-
-        QList<QSize> sizes = originalIcon.availableSizes(mode);
-        if (sizes.isEmpty())
-            sizes.append(QSize(24, 24));
-
-        QIcon newIcon;
-        for (const QSize &size : sizes) {
-            QPixmap pixmap = originalIcon.pixmap(size);
-
-            QPainter painter(&pixmap);
-            painter.setCompositionMode(QPainter::CompositionMode_SourceIn);
-            painter.fillRect(pixmap.rect(), QColor(50, 50, 50));  // Dark color for light theme
-            painter.end();
-
-            newIcon.addPixmap(pixmap, mode);
-        }
-
-        action->setIcon(newIcon);
-    }
+    updateActionIcons(false);
 
     QSettings settings("NotepadX", "Editor");
     settings.setValue("darkTheme", m_isDarkThemeActive);
@@ -177,32 +163,7 @@ void EditorManager::applyDarkTheme()
     qApp->setPalette(darkPalette);
     
     // Set toolbar icons to bright white for better visibility in dark theme
-    QList<QAction *> actions = m_mainWindow->findChildren<QAction *>();
-    for (QAction *action : actions) {
-        if (action->icon().isNull())
-            continue;
-
-        QIcon originalIcon = action->icon();
-        QIcon::Mode mode = QIcon::Normal;
-
-        QList<QSize> sizes = originalIcon.availableSizes(mode);
-        if (sizes.isEmpty())
-            sizes.append(QSize(24, 24));
-
-        QIcon newIcon;
-        for (const QSize &size : sizes) {
-            QPixmap pixmap = originalIcon.pixmap(size);
-
-            QPainter painter(&pixmap);
-            painter.setCompositionMode(QPainter::CompositionMode_SourceIn);
-            painter.fillRect(pixmap.rect(), QColor(255, 255, 255));  // Pure white for dark theme
-            painter.end();
-
-            newIcon.addPixmap(pixmap, mode);
-        }
-
-        action->setIcon(newIcon);
-    }
+    updateActionIcons(true);
 
     // Add styling specifically for tab alignment in dark mode
     QString styleSheet = QString(
@@ -232,6 +193,47 @@ void EditorManager::applyDarkTheme()
     settings.setValue("darkTheme", m_isDarkThemeActive);
 }
 
+void EditorManager::updateActionIcons(bool dark)
+{
+    QList<QAction *> actions = m_mainWindow->findChildren<QAction *>();
+    for (QAction *action : actions) {
+        if (action->icon().isNull())
+            continue;
+
+        // SVG icons come prerendered in the theme's colors from the cache
+        QString iconName = action->property("svgIcon").toString();
+        if (!iconName.isEmpty()) {
+            QIcon themedIcon = SvgIconProvider::themedIcon(iconName, dark);
+            if (!themedIcon.isNull()) {
+                action->setIcon(themedIcon);
+                continue;
+            }
+        }
+
+        // Anything else, like the font icon fallbacks, is recolored
+        QIcon originalIcon = action->icon();
+        QIcon::Mode mode = QIcon::Normal;
+
+        QList<QSize> sizes = originalIcon.availableSizes(mode);
+        if (sizes.isEmpty())
+            sizes.append(QSize(24, 24));
+
+        QIcon newIcon;
+        for (const QSize &size : sizes) {
+            QPixmap pixmap = originalIcon.pixmap(size);
+
+            QPainter painter(&pixmap);
+            painter.setCompositionMode(QPainter::CompositionMode_SourceIn);
+            painter.fillRect(pixmap.rect(), dark ? QColor(255, 255, 255) : QColor(50, 50, 50));
+            painter.end();
+
+            newIcon.addPixmap(pixmap, mode);
+        }
+
+        action->setIcon(newIcon);
+    }
+}
+
 void EditorManager::toggleWordWrap()
 {
     m_isWordWrapEnabled = !m_isWordWrapEnabled;
@@ -346,7 +348,7 @@ void EditorManager::connectEditorSignals()
         disconnect(codeEditor, &CodeEditor::cursorPositionChanged, nullptr, nullptr);
         connect(codeEditor, &CodeEditor::cursorPositionChanged, this, &EditorManager::updateCursorPosition);
         
-        disconnect(codeEditor, &CodeEditor::zoomLevelChanged, nullptr, nullptr);
+        disconnect(codeEditor, &CodeEditor::zoomLevelChanged, this, nullptr);
         connect(codeEditor, &CodeEditor::zoomLevelChanged, this, [this](int) {
             updateStatusBar();
         });
@@ -356,6 +358,38 @@ void EditorManager::connectEditorSignals()
     connect(editor, &EditorWidget::zoomLevelChanged, this, [this](int) {
         updateStatusBar();
     });
+
+    disconnect(editor, &EditorWidget::lineEndingsChanged, this, nullptr);
+    connect(editor, &EditorWidget::lineEndingsChanged, this, &EditorManager::updateStatusBar);
+
+    if (editor->hexViewer()) {
+        disconnect(editor->hexViewer(), &HexView::cursorOffsetChanged, this, nullptr);
+        connect(editor->hexViewer(), &HexView::cursorOffsetChanged, this, &EditorManager::updateCursorPosition);
+    }
+
+    disconnect(editor, &EditorWidget::followModeChanged, this, nullptr);
+    connect(editor, &EditorWidget::followModeChanged, this, &EditorManager::updateFollowAction);
+    updateFollowAction();
+}
+
+void EditorManager::toggleFollowMode()
+{
+    EditorWidget *editor = currentEditor();
+    if (editor)
+        editor->setFollowMode(!editor->isFollowing());
+    
+    // Keep the check mark in line when the editor refused
+    updateFollowAction();
+}
+
+void EditorManager::updateFollowAction()
+{
+    if (!m_followAction)
+        return;
+    
+    EditorWidget *editor = currentEditor();
+    m_followAction->setEnabled(editor != nullptr);
+    m_followAction->setChecked(editor && editor->isFollowing());
 }
 
 void EditorManager::updateTabText(int index)
@@ -422,6 +456,7 @@ void EditorManager::updateStatusBar()
     if (!editor) {
         m_lineColumnLabel->setText("Line: 1, Column: 1");
         m_zoomLabel->setText("Zoom: 100%");
+        m_lineEndingLabel->setText("");
         m_modifiedLabel->setText("");
         m_filenameLabel->setText("");
         return;
@@ -445,10 +480,19 @@ void EditorManager::updateStatusBar()
     int zoomPercent = 100 + (zoomLevel * 10);
     m_zoomLabel->setText(QString("Zoom: %1%").arg(zoomPercent));
 
+    QString lineEnding = LineEndingScanner::name(editor->lineEnding());
+    m_lineEndingLabel->setText(editor->hasMixedLineEndings() ? lineEnding + " (mixed)" : lineEnding);
+
+    if (HexView *hexView = editor->hexViewer()) {
+        qint64 offset = hexView->cursorOffset();
+        m_lineColumnLabel->setText(QString("Offset: 0x%1 (%2)").arg(offset, 0, 16).arg(offset));
+        return;
+    }
+
     CodeEditor *codeEditor = editor->editor();
     if (codeEditor) {
         QTextCursor cursor = codeEditor->textCursor();
-        int line = cursor.blockNumber() + 1;
+        qint64 line = cursor.blockNumber() + 1 + qMax<qint64>(0, codeEditor->getLineNumberOffset());
         int column = cursor.columnNumber() + 1;
         m_lineColumnLabel->setText(QString("Line: %1, Column: %2").arg(line).arg(column));
     }
@@ -463,7 +507,7 @@ void EditorManager::updateCursorPosition()
     CodeEditor *codeEditor = editor->editor();
     if (codeEditor) {
         QTextCursor cursor = codeEditor->textCursor();
-        int line = cursor.blockNumber() + 1;
+        qint64 line = cursor.blockNumber() + 1 + qMax<qint64>(0, codeEditor->getLineNumberOffset());
         int column = cursor.columnNumber() + 1;
         m_lineColumnLabel->setText(QString("Line: %1, Column: %2").arg(line).arg(column));
     }
@@ -45,6 +45,8 @@ public slots:
     void resetZoom();
     void toggleWordWrap();
     void updateWordWrapState(); // New method to ensure word wrap state is applied
+    void toggleFollowMode();
+    void updateFollowAction();
       // Setters
     void setLanguageActionGroup(QActionGroup *actionGroup) { m_languageActionGroup = actionGroup; }
     void setThemeActionGroup(QActionGroup *actionGroup) { m_themeActionGroup = actionGroup; }
@@ -58,17 +60,22 @@ private:
     QActionGroup *m_languageActionGroup;
     QActionGroup *m_themeActionGroup;
     QAction *m_wordWrapAction;
+    QAction *m_followAction;
     
     // Status bar label references - these will be set directly from MainWindow
     QLabel *m_lineColumnLabel;
     QLabel *m_modifiedLabel;
     QLabel *m_filenameLabel;
     QLabel *m_zoomLabel;
+    QLabel *m_lineEndingLabel;
     
     // Settings
     int m_currentZoomLevel;
     bool m_isDarkThemeActive;
     bool m_isWordWrapEnabled;
+    
+    // Sets the toolbar icons for the given theme
+    void updateActionIcons(bool dark);
 };
 
 #endif // EDITORMANAGER_H
\ No newline at end of file
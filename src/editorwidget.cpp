@@ -1,20 +1,49 @@
 #include "editorwidget.h"
 #include "codeeditor.h"  // Add this include
+#include "largefileview.h"
+#include "fileloader.h"
+#include "filesaver.h"
+#include "filewatcher.h"
+#include "filereloader.h"
+#include "compressedfile.h"
+#include "hexview.h"
 #include "highlighting/highlighterfactory.h"
 #include <QVBoxLayout>
 #include <QFileInfo>
 #include <QFile>
-#include <QTextStream>
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QDir>
 #include <QFontDatabase>
 #include <QSettings>
+#include <QHBoxLayout>
+#include <QScrollBar>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QLabel>
+#include <QTextCursor>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTextDocument>
+#include <QTextBlockFormat>
+#include <QDateTime>
+#include <QPointer>
 
-EditorWidget::EditorWidget(QWidget *parent) : QWidget(parent), currentFilePath(""), usingDarkTheme(false)
+EditorWidget::EditorWidget(QWidget *parent) : QWidget(parent), hexView(nullptr), largeFileView(nullptr), largeFileScrollBar(nullptr),
+    fileLoader(nullptr), loadingBar(nullptr), loadingProgress(nullptr), loadingLabel(nullptr),
+    loadingCancelButton(nullptr), appendTimer(nullptr), pendingOffset(0), loading(false),
+    loaderFinished(false), loaderTruncated(false), partiallyLoaded(false), fileSaver(nullptr), saveTimer(nullptr),
+    saveEncoder(nullptr), saveOffset(0), saving(false), fillingDocument(false), fileEncoding(EncodingDetector::Utf8),
+    lineEndingStyle(LineEndingScanner::platformDefault()), mixedLineEndings(false),
+    changeTimer(nullptr), following(false), followUpdating(false), followHeldCR(false),
+    followWasReadOnly(false), followOffset(0), fileReloader(nullptr), reloadRevision(0),
+    reloading(false), reloadPending(false), diskSize(-1), compressed(false), pending(false),
+    deferredCursorPosition(-1),
+    currentFilePath(""), usingDarkTheme(false)
 {
     // Create layout
-    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout = new QVBoxLayout(this);
     layout->setContentsMargins(0, 0, 0, 0);
     
     // Create text editor
@@ -25,19 +54,90 @@ EditorWidget::EditorWidget(QWidget *parent) : QWidget(parent), currentFilePath("
     highlighter = nullptr;
     updateHighlighter();
     
-    // Add widgets to layout
-    layout->addWidget(textEditor);
+    // Add widgets to layout - the editor sits in a row so the large file
+    // viewer can put its own scrollbar next to it
+    editorLayout = new QHBoxLayout;
+    editorLayout->setContentsMargins(0, 0, 0, 0);
+    editorLayout->setSpacing(0);
+    editorLayout->addWidget(textEditor);
+    layout->addLayout(editorLayout);
     
     setLayout(layout);
     
     // Connect signals for document modification
     connect(textEditor->document(), &QTextDocument::contentsChanged,
             this, &EditorWidget::documentWasModified);
+
+    // The highlighter recolors blocks left over from a theme change as
+    // they come into view
+    connect(textEditor, &CodeEditor::updateRequest, this, [this](const QRect &, int) {
+        if (highlighter)
+            highlighter->setVisibleBlocks(textEditor->firstVisibleBlockNumber(),
+                                          textEditor->lastVisibleBlockNumber());
+    });
+    
+    // Writers change files in many small steps; react to them in batches
+    changeTimer = new QTimer(this);
+    changeTimer->setSingleShot(true);
+    changeTimer->setInterval(ChangeBatchMs);
+    connect(changeTimer, &QTimer::timeout, this, &EditorWidget::fileChangedOnDisk);
+    connect(&FileWatcher::instance(), &FileWatcher::fileChanged, this, &EditorWidget::watchedFileChanged);
     
     // Initialize editor-specific settings and connections
     initEditor();
 }
 
+EditorWidget::~EditorWidget()
+{
+    FileWatcher::instance().unwatch(watchedPath);
+}
+
+void EditorWidget::setPending(const PendingTab &tab)
+{
+    pendingTab = tab;
+    pending = true;
+}
+
+EditorWidget::PendingTab EditorWidget::takePending()
+{
+    PendingTab tab = pendingTab;
+    pendingTab = PendingTab();
+    pending = false;
+    return tab;
+}
+
+QString EditorWidget::text() const
+{
+    return pending ? pendingTab.text : textEditor->toPlainText();
+}
+
+int EditorWidget::cursorPosition() const
+{
+    if (pending)
+        return pendingTab.cursorPosition;
+    if (largeFileView || hexView)
+        return 0;
+    return textEditor->textCursor().position();
+}
+
+void EditorWidget::setCursorPosition(int position)
+{
+    // The large file and hex views have no document position to restore
+    if (largeFileView || hexView)
+        return;
+    
+    // Streamed loads only know the full document once they are done
+    if (loading) {
+        deferredCursorPosition = position;
+        return;
+    }
+    
+    QTextCursor cursor = textEditor->textCursor();
+    cursor.setPosition(qBound(0, position, textEditor->document()->characterCount() - 1));
+    textEditor->setTextCursor(cursor);
+    textEditor->centerCursor();
+}
+
 void EditorWidget::setupEditor()
 {
     // Use platform-specific fonts that match VS Code defaults
@@ -98,8 +198,31 @@ void EditorWidget::initEditor()
 
 bool EditorWidget::loadFile(const QString &fileName)
 {
+    // Compressed files are inflated while they are streamed into the editor
+    CompressedFile::Format compression = CompressedFile::detect(fileName);
+    if (compression != CompressedFile::None)
+        return loadCompressedFile(fileName, compression);
+    
+    return loadTextFile(fileName, EncodingDetector::detectFile(fileName));
+}
+
+bool EditorWidget::loadTextFile(const QString &fileName, EncodingDetector::Encoding detected)
+{
+    compressed = false;
+    
+    // Laying out megabytes of binary data as text would hang the editor
+    if (detected == EncodingDetector::Binary)
+        return openHexView(fileName);
+    
+    fileEncoding = detected;
+    
+    // Big files are decoded off the GUI thread so the window stays responsive
+    if (QFileInfo(fileName).size() >= AsyncLoadThreshold) {
+        return startAsyncLoad(fileName);
+    }
+    
     QFile file(fileName);
-    if (!file.open(QFile::ReadOnly | QFile::Text)) {
+    if (!file.open(QFile::ReadOnly)) {
         QMessageBox::warning(this, "NotepadX",
                              tr("Cannot read file %1:\n%2.")
                              .arg(QDir::toNativeSeparators(fileName))
@@ -107,23 +230,769 @@ bool EditorWidget::loadFile(const QString &fileName)
         return false;
     }
     
-    QTextStream in(&file);
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-    in.setEncoding(QStringConverter::Utf8);
-#else
-    in.setCodec("UTF-8");
-#endif
+    // The byte order mark is not part of the text
+    file.seek(EncodingDetector::byteOrderMark(fileEncoding).size());
+    TextDecoder decoder(fileEncoding);
+    
+    QString text = decoder.decode(file.readAll());
+    LineEndingScanner lineEndings;
+    lineEndings.scan(text);
+    
+    if (text.size() <= FirstScreenChars) {
+        fillingDocument = true;
+        textEditor->setPlainText(text);
+        applyLineEndings(lineEndings);
+        fillingDocument = false;
+        
+        setCurrentFile(fileName);
+        updateHighlighter();  // Update highlighter based on file extension
+        return true;
+    }
+    
+    // Show the head of the file right away and stream the rest in
+    // from the event loop instead of laying out everything at once
+    beginLoading(fileName);
+    loadedLineEndings = lineEndings;
+    pendingChunks.enqueue(text);
+    loaderFinished = true;
+    pumpPendingChunks();
+    return true;
+}
+
+void EditorWidget::fillDocument(const QString &text)
+{
+    fillingDocument = true;
+    textEditor->setPlainText(text);
+    fillingDocument = false;
+}
+
+bool EditorWidget::loadCompressedFile(const QString &fileName, CompressedFile::Format format)
+{
+    if (!CompressedFile::isSupported(format)) {
+        QMessageBox::warning(this, "NotepadX",
+                             tr("Cannot read file %1:\nThis build of NotepadX cannot decompress %2 files.")
+                             .arg(QDir::toNativeSeparators(fileName))
+                             .arg(CompressedFile::formatName(format)));
+        return false;
+    }
+    
+    // The encoding is detected on the decompressed text
+    CompressedFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        QMessageBox::warning(this, "NotepadX",
+                             tr("Cannot read file %1:\n%2.")
+                             .arg(QDir::toNativeSeparators(fileName))
+                             .arg(file.errorString()));
+        return false;
+    }
+    EncodingDetector::Encoding detected = EncodingDetector::detectDevice(&file);
+    file.close();
+    
+    if (detected == EncodingDetector::Binary) {
+        QMessageBox::warning(this, "NotepadX",
+                             tr("Cannot open file %1:\nThe compressed data is not text.")
+                             .arg(QDir::toNativeSeparators(fileName)));
+        return false;
+    }
+    
+    // Always streamed in from the loader thread, whatever the size, since
+    // the compressed size says little about how much text there is
+    fileEncoding = detected;
+    compressed = true;
+    return startAsyncLoad(fileName);
+}
+
+bool EditorWidget::startAsyncLoad(const QString &fileName)
+{
+    // Check the file up front so open errors are reported synchronously
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly)) {
+        QMessageBox::warning(this, "NotepadX",
+                             tr("Cannot read file %1:\n%2.")
+                             .arg(QDir::toNativeSeparators(fileName))
+                             .arg(file.errorString()));
+        return false;
+    }
+    file.close();
+    
+    beginLoading(fileName);
+    
+    // beginLoading() has stopped and disconnected any previous reader
+    fileLoader = new FileLoader(this);
+    fileLoader->setEncoding(fileEncoding);
+    fileLoader->setCompressed(compressed);
+    connect(fileLoader, &FileLoader::chunkReady, this, &EditorWidget::appendLoadedChunk);
+    connect(fileLoader, &FileLoader::progress, this, &EditorWidget::updateLoadProgress);
+    connect(fileLoader, &FileLoader::loadFinished, this, &EditorWidget::finishLoading);
+    connect(fileLoader, &FileLoader::loadFailed, this, &EditorWidget::loadingFailed);
+    connect(fileLoader, &FileLoader::loadCancelled, this, &EditorWidget::loadingCancelled);
+    connect(fileLoader, &FileLoader::loadLimitReached, this, &EditorWidget::loadingLimitReached);
+    
+    // A compressed file cannot be mapped into the large file view, so only
+    // as much text as that view would take over from is inflated
+    if (compressed)
+        fileLoader->setSizeLimit(largeFileThreshold());
+    
+    createLoadingBar();
+    loadingLabel->setText(tr("Loading %1...").arg(QFileInfo(fileName).fileName()));
+    loadingProgress->setValue(0);
+    loadingProgress->show();
+    loadingCancelButton->show();
+    loadingBar->show();
+    
+    // A small first read gets the head of the file on screen quickly
+    fileLoader->load(fileName, FirstScreenChars);
+    return true;
+}
+
+void EditorWidget::beginLoading(const QString &fileName)
+{
+    stopLoader();
+    
+    if (!appendTimer) {
+        appendTimer = new QTimer(this);
+        appendTimer->setInterval(0);
+        connect(appendTimer, &QTimer::timeout, this, &EditorWidget::pumpPendingChunks);
+    }
+    
+    // The document is filled by appends only, so keep the user out of it
+    // and skip recording an undo step for every chunk
+    loading = true;
+    loaderFinished = false;
+    loaderTruncated = false;
+    partiallyLoaded = false;
+    pendingChunks.clear();
+    pendingOffset = 0;
+    textEditor->clear();
+    textEditor->setReadOnly(true);
+    textEditor->setUndoRedoEnabled(false);
+    
+    setCurrentFile(fileName);
+    updateHighlighter();
+}
+
+void EditorWidget::stopLoader()
+{
+    // A reader still working on the previous file must not feed this one
+    if (fileLoader) {
+        fileLoader->disconnect(this);
+        fileLoader->cancel();
+        delete fileLoader;
+        fileLoader = nullptr;
+    }
+}
+
+void EditorWidget::createLoadingBar()
+{
+    if (loadingBar)
+        return;
+    
+    loadingBar = new QWidget(this);
+    QHBoxLayout *barLayout = new QHBoxLayout(loadingBar);
+    barLayout->setContentsMargins(6, 3, 6, 3);
+    
+    loadingLabel = new QLabel(loadingBar);
+    barLayout->addWidget(loadingLabel);
+    
+    loadingProgress = new QProgressBar(loadingBar);
+    loadingProgress->setRange(0, 1000);
+    loadingProgress->setTextVisible(false);
+    loadingProgress->setMaximumHeight(12);
+    barLayout->addWidget(loadingProgress, 1);
+    
+    loadingCancelButton = new QPushButton(tr("Cancel"), loadingBar);
+    barLayout->addWidget(loadingCancelButton);
+    connect(loadingCancelButton, &QPushButton::clicked, this, &EditorWidget::cancelLoading);
+    
+    layout->insertWidget(0, loadingBar);
+}
+
+void EditorWidget::appendLoadedChunk(const QString &text)
+{
+    // Chunks a replaced reader queued before it was stopped are dropped
+    if (sender() != fileLoader)
+        return;
+    pendingChunks.enqueue(text);
+    if (!appendTimer->isActive())
+        pumpPendingChunks();
+}
+
+void EditorWidget::pumpPendingChunks()
+{
+    QElapsedTimer budget;
+    budget.start();
+    
+    // Append line-aligned slices until the time budget for this event loop
+    // iteration is used up, so painting and input are never starved. The
+    // gutter and scrollbar follow the block count as it grows.
+    QTextCursor cursor(textEditor->document());
+    while (!pendingChunks.isEmpty() && budget.elapsed() < AppendBudgetMs) {
+        const QString &chunk = pendingChunks.head();
+        
+        int end = qMin(pendingOffset + AppendSliceChars, chunk.size());
+        if (end < chunk.size()) {
+            int newline = chunk.lastIndexOf(QLatin1Char('\n'), end - 1);
+            if (newline >= pendingOffset)
+                end = newline + 1;
+        }
+        
+        cursor.movePosition(QTextCursor::End);
+        cursor.insertText(chunk.mid(pendingOffset, end - pendingOffset));
+        pendingOffset = end;
+        
+        if (pendingOffset >= chunk.size()) {
+            pendingChunks.dequeue();
+            pendingOffset = 0;
+            if (fileLoader)
+                fileLoader->chunkConsumed();
+        }
+    }
+    textEditor->document()->setModified(false);
+    
+    if (!pendingChunks.isEmpty()) {
+        appendTimer->start();
+        return;
+    }
+    
+    appendTimer->stop();
+    if (loaderFinished)
+        completeLoading();
+}
+
+void EditorWidget::updateLoadProgress(qint64 bytesRead, qint64 totalBytes)
+{
+    if (loadingProgress && totalBytes > 0)
+        loadingProgress->setValue(static_cast<int>(bytesRead * 1000 / totalBytes));
+}
+
+void EditorWidget::endLoading()
+{
+    loading = false;
+    pendingChunks.clear();
+    pendingOffset = 0;
+    if (appendTimer)
+        appendTimer->stop();
+    
+    textEditor->setUndoRedoEnabled(true);
+    textEditor->document()->setModified(false);
+    
+    if (fileLoader) {
+        fileLoader->deleteLater();
+        fileLoader = nullptr;
+    }
+}
+
+void EditorWidget::finishLoading()
+{
+    if (sender() != fileLoader)
+        return;
+    // The reader is done, but queued chunks may still be waiting to be appended
+    loaderFinished = true;
+    loadedLineEndings = fileLoader->lineEndings();
+    if (pendingChunks.isEmpty())
+        completeLoading();
+}
+
+void EditorWidget::completeLoading()
+{
+    endLoading();
+    applyLineEndings(loadedLineEndings);
+    
+    // Saving the head of a file that was cut off would truncate it on disk
+    if (loaderTruncated) {
+        partiallyLoaded = true;
+        loadingLabel->setText(tr("File too large to decompress - showing the first %1 MB (read-only)")
+                              .arg(largeFileThreshold() / (1024 * 1024)));
+        loadingProgress->hide();
+        loadingCancelButton->hide();
+        return;
+    }
+    
+    textEditor->setReadOnly(false);
+    if (loadingBar)
+        loadingBar->hide();
+    
+    if (deferredCursorPosition >= 0) {
+        setCursorPosition(deferredCursorPosition);
+        deferredCursorPosition = -1;
+    }
+    emit loadFinished();
+}
+
+void EditorWidget::applyLineEndings(const LineEndingScanner &lineEndings)
+{
+    lineEndingStyle = lineEndings.dominantStyle();
+    mixedLineEndings = lineEndings.isMixed();
+    
+    // Lines that differ from the dominant style carry their own terminator,
+    // so it follows them around through edits and is written back on save
+    QTextDocument *document = textEditor->document();
+    bool undoEnabled = document->isUndoRedoEnabled();
+    document->setUndoRedoEnabled(false);
+    
+    const QVector<LineEndingScanner::Run> &runs = lineEndings.runs();
+    for (int i = 0; i < runs.size(); ++i) {
+        if (runs.at(i).style == lineEndingStyle)
+            continue;
+        
+        QTextBlockFormat format;
+        format.setProperty(LineEndingScanner::BlockProperty, static_cast<int>(runs.at(i).style));
+        
+        qint64 end = i + 1 < runs.size() ? runs.at(i + 1).firstLine : lineEndings.lineCount();
+        QTextBlock block = document->findBlockByNumber(static_cast<int>(runs.at(i).firstLine));
+        for (qint64 line = runs.at(i).firstLine; line < end && block.isValid(); ++line, block = block.next())
+            QTextCursor(block).mergeBlockFormat(format);
+    }
+    
+    document->setUndoRedoEnabled(undoEnabled);
+    document->setModified(false);
+    emit lineEndingsChanged();
+}
+
+void EditorWidget::loadingFailed(const QString &errorString)
+{
+    if (sender() != fileLoader)
+        return;
+    // Whatever arrived stays visible but must never be saved over the original
+    endLoading();
+    partiallyLoaded = true;
+    loadingLabel->setText(tr("Loading failed - showing partial content (read-only)"));
+    loadingProgress->hide();
+    loadingCancelButton->hide();
+    
+    QMessageBox::warning(this, "NotepadX",
+                         tr("Cannot read file %1:\n%2.")
+                         .arg(QDir::toNativeSeparators(currentFilePath))
+                         .arg(errorString));
+}
+
+void EditorWidget::loadingCancelled()
+{
+    if (sender() != fileLoader)
+        return;
+    endLoading();
+    partiallyLoaded = true;
+    loadingLabel->setText(tr("Loading cancelled - showing partial content (read-only)"));
+    loadingProgress->hide();
+    loadingCancelButton->hide();
+}
+
+void EditorWidget::loadingLimitReached()
+{
+    if (sender() != fileLoader)
+        return;
+    // Queued chunks are still appended; completeLoading() keeps it read-only
+    loaderTruncated = true;
+    finishLoading();
+}
+
+void EditorWidget::cancelLoading()
+{
+    if (fileLoader)
+        fileLoader->cancel();
+    if (fileSaver)
+        fileSaver->cancel();
+}
+
+bool EditorWidget::openHexView(const QString &fileName)
+{
+    bool created = !hexView;
+    if (created) {
+        hexView = new HexView(this);
+        hexView->setFont(textEditor->font());
+        hexView->setDarkTheme(usingDarkTheme);
+        connect(textEditor, &CodeEditor::zoomLevelChanged, hexView, [this](int) {
+            hexView->setFont(textEditor->font());
+        });
+        // The text editor is hidden, so its own Ctrl+wheel never fires
+        connect(hexView, &HexView::zoomRequested, this, [this](int steps) {
+            if (steps > 0)
+                zoomIn(steps);
+            else
+                zoomOut(-steps);
+        });
+        editorLayout->addWidget(hexView);
+    }
+    
+    if (!hexView->open(fileName)) {
+        QMessageBox::warning(this, "NotepadX",
+                             tr("Cannot read file %1:\n%2.")
+                             .arg(QDir::toNativeSeparators(fileName))
+                             .arg(hexView->errorString()));
+        if (created) {
+            delete hexView;
+            hexView = nullptr;
+        }
+        return false;
+    }
+    
+    // The text editor stays around for zoom and theme state only
+    textEditor->hide();
+    hexView->show();
+    hexView->setFocus();
+    fileEncoding = EncodingDetector::Binary;
+    compressed = false;
+    setCurrentFile(fileName);
+    return true;
+}
+
+bool EditorWidget::openLargeFile(const QString &fileName)
+{
+    // The view maps the file, which needs it uncompressed, and finds line
+    // breaks byte by byte, which does not work for UTF-16. The encoding is
+    // detected once and handed on to whichever loader takes the file.
+    if (CompressedFile::detect(fileName) != CompressedFile::None)
+        return loadFile(fileName);
+    EncodingDetector::Encoding detected = EncodingDetector::detectFile(fileName);
+    if (detected == EncodingDetector::Binary)
+        return openHexView(fileName);
+    if (!EncodingDetector::isByteOriented(detected))
+        return loadTextFile(fileName, detected);
     
-    textEditor->setPlainText(in.readAll());
+    compressed = false;
+    
+    if (!largeFileView) {
+        largeFileScrollBar = new QScrollBar(Qt::Vertical, this);
+        editorLayout->addWidget(largeFileScrollBar);
+        largeFileView = new LargeFileView(textEditor, largeFileScrollBar, this);
+        connect(largeFileView, &LargeFileView::modificationChanged, this, &EditorWidget::modificationChanged);
+    }
+    
+    // Binary files are shown read-only until there is a proper hex view
+    largeFileView->setEncoding(detected);
+    fillingDocument = true;
+    bool opened = largeFileView->open(fileName);
+    fillingDocument = false;
+    if (!opened) {
+        QMessageBox::warning(this, "NotepadX",
+                             tr("Cannot read file %1:\n%2.")
+                             .arg(QDir::toNativeSeparators(fileName))
+                             .arg(largeFileView->errorString()));
+        return false;
+    }
+    
+    fileEncoding = detected;
+    lineEndingStyle = largeFileView->lineEndingStyle();
+    mixedLineEndings = largeFileView->hasMixedLineEndings();
+    emit lineEndingsChanged();
     
     setCurrentFile(fileName);
-    updateHighlighter();  // Update highlighter based on file extension
+    updateHighlighter();  // Only the visible window is ever highlighted
+    return true;
+}
+
+qint64 EditorWidget::largeFileThreshold()
+{
+    QSettings settings("NotepadX", "Editor");
+    return settings.value("largeFileThresholdMB", 512).toLongLong() * 1024 * 1024;
+}
+
+bool EditorWidget::setFollowMode(bool enabled)
+{
+    if (enabled == following)
+        return true;
+    
+    if (enabled) {
+        if (currentFilePath.isEmpty() || largeFileView || hexView || loading || partiallyLoaded || compressed || saving) {
+            QMessageBox::information(this, "NotepadX",
+                                     tr("Follow mode is only available for uncompressed files fully loaded into the editor."));
+            return false;
+        }
+        if (isModified()) {
+            QMessageBox::information(this, "NotepadX",
+                                     tr("Save or discard your changes to %1 before following it.")
+                                     .arg(QDir::toNativeSeparators(currentFilePath)));
+            return false;
+        }
+        
+        // What is on screen now is the file up to its current size; the
+        // document becomes a read-only tail of the file from here on
+        QFileInfo info(currentFilePath);
+        followOffset = info.size();
+        followBirthTime = info.birthTime();
+        followDecoder.reset(new TextDecoder(fileEncoding));
+        followHeldCR = false;
+        followWasReadOnly = textEditor->isReadOnly();
+        textEditor->setReadOnly(true);
+        textEditor->setUndoRedoEnabled(false);
+        
+        following = true;
+    } else {
+        following = false;
+        followDecoder.reset();
+        textEditor->setReadOnly(followWasReadOnly);
+        textEditor->setUndoRedoEnabled(true);
+    }
+    
+    emit followModeChanged(following);
     return true;
 }
 
+void EditorWidget::watchedFileChanged(const QString &fileName)
+{
+    if (fileName == currentFilePath && !changeTimer->isActive())
+        changeTimer->start();
+}
+
+void EditorWidget::fileChangedOnDisk()
+{
+    if (following) {
+        readAppendedData();
+        return;
+    }
+    
+    // The large file view reads the file itself, and a document that is
+    // still loading is not comparable to the file
+    if (largeFileView || hexView || loading || partiallyLoaded || compressed)
+        return;
+    
+    // Looked at again once the save is done
+    if (saving) {
+        reloadPending = true;
+        return;
+    }
+    
+    // A file that was deleted may be about to be replaced; the watcher
+    // reports it again when it is back
+    QFileInfo info(currentFilePath);
+    if (!info.exists())
+        return;
+    
+    // Our own saves and touches that did not change anything end here
+    if (info.size() == diskSize && info.lastModified() == diskModified)
+        return;
+    
+    if (reloading) {
+        reloadPending = true;
+        return;
+    }
+    rememberDiskState();
+    
+    reloading = true;
+    if (isModified()) {
+        QMessageBox::StandardButton answer =
+            QMessageBox::question(this, "NotepadX",
+                                  tr("%1 has been changed by another program.\n"
+                                     "Reload it? Your changes can be brought back with Undo.")
+                                  .arg(QDir::toNativeSeparators(currentFilePath)),
+                                  QMessageBox::Yes | QMessageBox::No);
+        if (answer != QMessageBox::Yes) {
+            finishReload();
+            return;
+        }
+    }
+    startReload();
+}
+
+void EditorWidget::rememberDiskState()
+{
+    QFileInfo info(currentFilePath);
+    diskSize = info.exists() ? info.size() : -1;
+    diskModified = info.lastModified();
+}
+
+void EditorWidget::startReload()
+{
+    if (!fileReloader) {
+        fileReloader = new FileReloader(this);
+        connect(fileReloader, &QThread::finished, this, &EditorWidget::reloadFinished);
+    }
+    
+    // Snapshot the document the way it would be saved, so lines whose
+    // terminator changed on disk show up in the diff as well
+    QString text;
+    QVector<quint8> styles;
+    QTextDocument *document = textEditor->document();
+    if (mixedLineEndings)
+        styles.reserve(document->blockCount());
+    for (QTextBlock block = document->begin(); block.isValid(); block = block.next()) {
+        if (block != document->begin())
+            text += QLatin1Char('\n');
+        text += block.text();
+        if (mixedLineEndings) {
+            QVariant style = block.blockFormat().property(LineEndingScanner::BlockProperty);
+            styles.append(static_cast<quint8>(style.isValid() ? style.toInt() : lineEndingStyle));
+        }
+    }
+    
+    reloadRevision = document->revision();
+    fileReloader->reload(currentFilePath, text, styles, lineEndingStyle);
+}
+
+void EditorWidget::applyReload()
+{
+    QTextDocument *document = textEditor->document();
+    if (saving)
+        reloadPending = true;
+    if (fileReloader->fileName() != currentFilePath || largeFileView || following || loading || saving) {
+        finishReload();
+        return;
+    }
+    
+    // The user typed while the diff was being worked out; compare again
+    if (document->revision() != reloadRevision) {
+        startReload();
+        return;
+    }
+    
+    fileEncoding = fileReloader->encoding();
+    const QVector<FileReloader::Hunk> &hunks = fileReloader->hunks();
+    QScrollBar *scrollBar = textEditor->verticalScrollBar();
+    int scrollPosition = scrollBar->value();
+    
+    // Hunks are applied back to front so the line numbers of the ones
+    // still to come stay valid, and all of them form one undo step. The
+    // highlighter only sees the blocks that are actually touched.
+    QTextCursor cursor(document);
+    cursor.beginEditBlock();
+    for (int i = hunks.size() - 1; i >= 0; --i) {
+        const FileReloader::Hunk &hunk = hunks.at(i);
+        QString text = hunk.lines.join(QLatin1Char('\n'));
+        int end = hunk.oldStart + hunk.oldCount;
+        if (end < document->blockCount()) {
+            cursor.setPosition(document->findBlockByNumber(hunk.oldStart).position());
+            cursor.setPosition(document->findBlockByNumber(end).position(), QTextCursor::KeepAnchor);
+            if (!hunk.lines.isEmpty())
+                text += QLatin1Char('\n');
+        } else if (hunk.oldStart > 0) {
+            // Up to the end of the document: take the preceding separator instead
+            QTextBlock previous = document->findBlockByNumber(hunk.oldStart - 1);
+            cursor.setPosition(previous.position() + previous.length() - 1);
+            cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
+            if (!hunk.lines.isEmpty())
+                text.prepend(QLatin1Char('\n'));
+        } else {
+            cursor.select(QTextCursor::Document);
+        }
+        cursor.insertText(text);
+        
+        // New blocks inherit the format of the block they were typed into
+        QTextBlock block = document->findBlockByNumber(hunk.oldStart);
+        for (int line = 0; line < hunk.lines.size() && block.isValid(); ++line, block = block.next()) {
+            quint8 style = hunk.styles.at(line);
+            bool ownStyle = style != FileReloader::NoTerminator && style != lineEndingStyle;
+            QVariant current = block.blockFormat().property(LineEndingScanner::BlockProperty);
+            if (ownStyle == current.isValid() && (!ownStyle || current.toInt() == style))
+                continue;
+            
+            QTextBlockFormat format = block.blockFormat();
+            if (ownStyle)
+                format.setProperty(LineEndingScanner::BlockProperty, static_cast<int>(style));
+            else
+                format.clearProperty(LineEndingScanner::BlockProperty);
+            QTextCursor(block).setBlockFormat(format);
+        }
+    }
+    cursor.endEditBlock();
+    scrollBar->setValue(scrollPosition);
+    
+    // Lines keep the terminator they have on disk, while the document as a
+    // whole keeps the style it is saved with
+    const LineEndingScanner &lineEndings = fileReloader->lineEndings();
+    mixedLineEndings = lineEndings.isMixed()
+                       || (lineEndings.lineCount() > 0 && lineEndings.dominantStyle() != lineEndingStyle);
+    document->setModified(false);
+    emit lineEndingsChanged();
+    
+    finishReload();
+}
+
+void EditorWidget::reloadFinished()
+{
+    if (fileReloader->succeeded()) {
+        applyReload();
+        return;
+    }
+    
+    if (!fileReloader->wasCancelled()) {
+        QMessageBox::warning(this, "NotepadX",
+                             tr("Cannot reload file %1:\n%2.")
+                             .arg(QDir::toNativeSeparators(currentFilePath))
+                             .arg(fileReloader->errorString()));
+    }
+    finishReload();
+}
+
+void EditorWidget::finishReload()
+{
+    reloading = false;
+    
+    // A save in progress picks the change up once it is done
+    if (reloadPending && !saving) {
+        reloadPending = false;
+        changeTimer->start();
+    }
+}
+
+void EditorWidget::readAppendedData()
+{
+    // A rotated file is gone until the writer recreates it; the watcher
+    // reports it again once it is back
+    QFileInfo info(currentFilePath);
+    if (!following || !info.exists())
+        return;
+    
+    QDateTime birthTime = info.birthTime();
+    bool replaced = birthTime.isValid() && followBirthTime.isValid() && birthTime != followBirthTime;
+    if (info.size() < followOffset || replaced) {
+        // Truncated or replaced by a new file: start over with its contents
+        followOffset = 0;
+        followBirthTime = birthTime;
+        followDecoder.reset(new TextDecoder(fileEncoding));
+        followHeldCR = false;
+        
+        followUpdating = true;
+        textEditor->clear();
+        textEditor->document()->setModified(false);
+        followUpdating = false;
+    }
+    
+    QFile file(currentFilePath);
+    if (info.size() == followOffset || !file.open(QFile::ReadOnly))
+        return;
+    
+    // Only the bytes past the last known end are read
+    QByteArray bom = EncodingDetector::byteOrderMark(fileEncoding);
+    if (followOffset == 0 && !bom.isEmpty() && file.peek(bom.size()) == bom)
+        followOffset = bom.size();
+    file.seek(followOffset);
+    QByteArray bytes = file.readAll();
+    followOffset += bytes.size();
+    
+    QString text = followDecoder->decode(bytes);
+    if (followHeldCR)
+        text.prepend(QLatin1Char('\r'));
+    
+    // A CR at the end may be the first half of a CRLF still being written
+    followHeldCR = text.endsWith(QLatin1Char('\r'));
+    if (followHeldCR)
+        text.chop(1);
+    
+    LineEndingScanner lineEndings;
+    lineEndings.scan(text);
+    if (text.isEmpty())
+        return;
+    
+    // Only keep scrolling along if the user was already looking at the end
+    QScrollBar *scrollBar = textEditor->verticalScrollBar();
+    bool atBottom = scrollBar->value() == scrollBar->maximum();
+    
+    followUpdating = true;
+    QTextCursor cursor(textEditor->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(text);
+    textEditor->document()->setModified(false);
+    followUpdating = false;
+    
+    if (atBottom)
+        scrollBar->setValue(scrollBar->maximum());
+}
+
 bool EditorWidget::save()
 {
-    if (currentFilePath.isEmpty()) {
+    // There is no compressor behind the loader, so edits to a compressed
+    // file are written to a new, uncompressed one
+    if (currentFilePath.isEmpty() || compressed) {
         return saveAs();
     } else {
         return saveFile(currentFilePath);
@@ -132,41 +1001,220 @@ bool EditorWidget::save()
 
 bool EditorWidget::saveAs()
 {
+    QString suggestion = currentFilePath;
+    if (compressed) {
+        QFileInfo info(currentFilePath);
+        suggestion = info.absoluteDir().filePath(info.completeBaseName());
+    }
     QString fileName = QFileDialog::getSaveFileName(this, "Save As", currentFilePath.isEmpty() ? 
-                                                  QDir::homePath() : currentFilePath);
+                                                  QDir::homePath() : suggestion);
     if (fileName.isEmpty())
         return false;
+    
+    if (compressed && QFileInfo(fileName) == QFileInfo(currentFilePath)) {
+        QMessageBox::warning(this, "NotepadX",
+                             tr("Cannot save file %1:\nCompressed files can only be saved uncompressed, "
+                                "under a different name.")
+                             .arg(QDir::toNativeSeparators(fileName)));
+        return false;
+    }
         
     return saveFile(fileName);
 }
 
 bool EditorWidget::saveFile(const QString &fileName)
 {
-    QFile file(fileName);
-    if (!file.open(QFile::WriteOnly | QFile::Text)) {
-        QMessageBox::warning(this, "NotepadX",
-                           tr("Cannot write file %1:\n%2.")
-                           .arg(QDir::toNativeSeparators(fileName))
-                           .arg(file.errorString()));
+    if (saving)
+        return false;
+    
+    // The file on disk is about to stop matching what is being followed
+    if (following)
+        setFollowMode(false);
+    
+    // The hidden text editor is empty; saving it would wipe the file
+    if (hexView) {
+        QMessageBox::information(this, "NotepadX",
+                                 tr("%1 is a binary file and is opened read-only.")
+                                 .arg(QDir::toNativeSeparators(currentFilePath)));
         return false;
     }
     
-    QTextStream out(&file);
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-    out.setEncoding(QStringConverter::Utf8);
-#else
-    out.setCodec("UTF-8");
-#endif
+    // Writing a half-loaded document would truncate the file on disk
+    if (loading || partiallyLoaded) {
+        QMessageBox::information(this, "NotepadX",
+                                 tr("%1 was not fully loaded and cannot be saved.")
+                                 .arg(QDir::toNativeSeparators(currentFilePath)));
+        return false;
+    }
     
-    out << textEditor->toPlainText();
+    QSettings settings("NotepadX", "Editor");
+    FileSaver saver;
+    saver.setSyncToDisk(settings.value("fsyncOnSave", true).toBool());
+    
+    // Text is written back in the encoding it was read in. The large file
+    // view copies raw bytes, so its byte order mark is already in the data.
+    TextEncoder encoder(fileEncoding);
+    saveEncoder = &encoder;
+    if (!largeFileView) {
+        QByteArray bom = EncodingDetector::byteOrderMark(fileEncoding);
+        if (!bom.isEmpty())
+            saver.write(bom);
+    }
     
+    if (!saveTimer) {
+        saveTimer = new QTimer(this);
+        saveTimer->setInterval(0);
+        connect(saveTimer, &QTimer::timeout, this, &EditorWidget::pumpSaveChunks);
+    }
+    
+    // The document is read on this thread in small slices while the worker
+    // writes, so it is kept read-only until the save has completed
+    bool wasReadOnly = textEditor->isReadOnly();
+    textEditor->setReadOnly(true);
+    saving = true;
+    fileSaver = &saver;
+    saveBlock = textEditor->document()->begin();
+    saveOffset = 0;
+    
+    qint64 saveSize = largeFileView ? largeFileView->fileSize() : textEditor->document()->characterCount();
+    if (saveSize >= AsyncLoadThreshold) {
+        createLoadingBar();
+        loadingLabel->setText(tr("Saving %1...").arg(QFileInfo(fileName).fileName()));
+        loadingProgress->setValue(0);
+        loadingProgress->show();
+        loadingCancelButton->show();
+        loadingBar->show();
+    }
+    
+    // Keep the UI alive until the worker is done so callers still get a result.
+    // maybeSave() refuses to let the tab close meanwhile, but if the widget is
+    // destroyed anyway there is nothing left to restore.
+    QPointer<EditorWidget> self(this);
+    QEventLoop loop;
+    connect(&saver, &QThread::finished, &loop, &QEventLoop::quit);
+    saver.save(fileName);
+    saveTimer->start();
+    loop.exec();
+    saver.wait();
+    if (!self)
+        return false;
+    
+    saveTimer->stop();
+    fileSaver = nullptr;
+    saveEncoder = nullptr;
+    saving = false;
+    textEditor->setReadOnly(wasReadOnly);
+    
+    // Changes seen on disk meanwhile are checked once the batch interval has
+    // passed; by then the disk state of our own write has been remembered
+    if (reloadPending && !reloading) {
+        reloadPending = false;
+        changeTimer->start();
+    }
+    if (loadingBar)
+        loadingBar->hide();
+    
+    if (!saver.succeeded()) {
+        if (!saver.wasCancelled()) {
+            QMessageBox::warning(this, "NotepadX",
+                               tr("Cannot write file %1:\n%2.")
+                               .arg(QDir::toNativeSeparators(fileName))
+                               .arg(saver.errorString()));
+        }
+        // Nothing was replaced, so the edits still apply to the file on disk
+        if (largeFileView && largeFileView->isReleased() && !largeFileView->restoreFile())
+            largeFileLost(currentFilePath);
+        return false;
+    }
+    
+    // The mapping was let go of before the rename; map the saved file instead
+    if (largeFileView && !largeFileView->reopen(fileName))
+        largeFileLost(fileName);
+    
+    compressed = false;
     setCurrentFile(fileName);
     return true;
 }
 
+void EditorWidget::pumpSaveChunks()
+{
+    QElapsedTimer budget;
+    budget.start();
+    
+    while (fileSaver->canWrite() && budget.elapsed() < AppendBudgetMs) {
+        QByteArray chunk = nextSaveChunk();
+        if (chunk.isEmpty()) {
+            // Everything has been read, and Windows won't rename over a
+            // file that is still mapped
+            if (largeFileView)
+                largeFileView->releaseFile();
+            fileSaver->finish();
+            saveTimer->stop();
+            break;
+        }
+        fileSaver->write(chunk);
+    }
+    
+    if (largeFileView)
+        updateLoadProgress(saveOffset, largeFileView->fileSize());
+    else
+        updateLoadProgress(saveBlock.isValid() ? saveBlock.position() : textEditor->document()->characterCount(),
+                           textEditor->document()->characterCount());
+}
+
+void EditorWidget::largeFileLost(const QString &fileName)
+{
+    QMessageBox::warning(this, "NotepadX",
+                         tr("Cannot read file %1:\n%2.")
+                         .arg(QDir::toNativeSeparators(fileName))
+                         .arg(largeFileView->errorString()));
+    
+    // The view has nothing left to read from; keep what is on screen, but
+    // don't let it be edited or saved until the file is opened again
+    partiallyLoaded = true;
+    textEditor->setReadOnly(true);
+    createLoadingBar();
+    loadingLabel->setText(tr("File is no longer readable - open it again to continue (read-only)"));
+    loadingProgress->hide();
+    loadingCancelButton->hide();
+    loadingBar->show();
+}
+
+QByteArray EditorWidget::nextSaveChunk()
+{
+    if (largeFileView) {
+        QByteArray chunk = largeFileView->readBytes(saveOffset, SaveChunkSize);
+        saveOffset += chunk.size();
+        return chunk;
+    }
+    
+    // Collect whole blocks until the chunk is big enough
+    const QString lineBreak = LineEndingScanner::sequence(lineEndingStyle);
+    QString text;
+    while (saveBlock.isValid() && text.size() < SaveChunkSize) {
+        text += saveBlock.text();
+        
+        QVariant style = saveBlock.blockFormat().property(LineEndingScanner::BlockProperty);
+        saveBlock = saveBlock.next();
+        if (saveBlock.isValid()) {
+            text += style.isValid() ? LineEndingScanner::sequence(static_cast<LineEndingScanner::Style>(style.toInt()))
+                                    : lineBreak;
+        }
+    }
+    return saveEncoder->encode(text);
+}
+
 void EditorWidget::setCurrentFile(const QString &fileName)
 {
     currentFilePath = QFileInfo(fileName).canonicalFilePath();
+    
+    // Every open file is watched for changes made by other programs
+    if (watchedPath != currentFilePath) {
+        FileWatcher::instance().unwatch(watchedPath);
+        FileWatcher::instance().watch(currentFilePath);
+        watchedPath = currentFilePath;
+    }
+    rememberDiskState();
     textEditor->document()->setModified(false);
     emit fileNameChanged(currentFilePath);
     emit modificationChanged(false);
@@ -209,16 +1257,25 @@ void EditorWidget::setLanguage(const QString &language)
 
 QString EditorWidget::currentLanguage() const
 {
+    if (pending && !pendingTab.language.isEmpty())
+        return pendingTab.language;
     return highlighter ? highlighter->languageName() : "Plain Text";
 }
 
 void EditorWidget::documentWasModified()
 {
+    // Appends from the background loader or follow mode are not user
+    // modifications, and the large file view reports changes to its own buffer
+    if (loading || followUpdating || largeFileView)
+        return;
+    
     emit modificationChanged(textEditor->document()->isModified());
 }
 
 bool EditorWidget::isModified() const
 {
+    if (largeFileView)
+        return largeFileView->isModified();
     return textEditor->document()->isModified();
 }
 
@@ -229,6 +1286,15 @@ void EditorWidget::setModified(bool modified)
 
 bool EditorWidget::maybeSave()
 {
+    // The save runs in a nested event loop on this widget; closing the tab
+    // or the window now would destroy it underneath that loop
+    if (saving) {
+        QMessageBox::information(this, "NotepadX",
+                                 tr("%1 is still being saved.")
+                                 .arg(QDir::toNativeSeparators(currentFilePath)));
+        return false;
+    }
+    
     if (!isModified())
         return true;
         
@@ -265,6 +1331,8 @@ void EditorWidget::setLightTheme()
     // Update line number area highlighting - Explicitly set theme state
     textEditor->setDarkTheme(false);
     textEditor->updateLineNumberAreaForTheme(false);
+    if (hexView)
+        hexView->setDarkTheme(false);
 }
 
 void EditorWidget::setDarkTheme()
@@ -289,16 +1357,20 @@ void EditorWidget::setDarkTheme()
     // Update line number area highlighting - Explicitly set theme state
     textEditor->setDarkTheme(true);
     textEditor->updateLineNumberAreaForTheme(true);
+    if (hexView)
+        hexView->setDarkTheme(true);
 }
 
 void EditorWidget::undo()
 {
-    if (textEditor) textEditor->undo();
+    if (largeFileView) largeFileView->undo();
+    else if (textEditor) textEditor->undo();
 }
 
 void EditorWidget::redo()
 {
-    if (textEditor) textEditor->redo();
+    if (largeFileView) largeFileView->redo();
+    else if (textEditor) textEditor->redo();
 }
 
 void EditorWidget::cut()
@@ -5,22 +5,82 @@
 #include <QString>
 #include <QVBoxLayout>  // Add this include for QVBoxLayout
 #include <QTextOption>  // Add this include for QTextOption
+#include <QQueue>
+#include <QTextBlock>
+#include <QDateTime>
+#include <QScopedPointer>
+#include "encodingdetector.h"
+#include "lineendings.h"
+#include "compressedfile.h"
 
 class CodeEditor;
 class SyntaxHighlighter;
+class LargeFileView;
+class FileLoader;
+class FileSaver;
+class FileReloader;
+class HexView;
+class QHBoxLayout;
+class QScrollBar;
+class QProgressBar;
+class QPushButton;
+class QLabel;
+class QTimer;
 
 class EditorWidget : public QWidget
 {
     Q_OBJECT
 
 public:
+    // What a restored tab needs to become a real one when it is first shown
+    struct PendingTab {
+        QString fileName;
+        QString text;
+        QString textBlob;   // session store file holding the text instead
+        QString language;
+        int cursorPosition;
+    };
+    
     explicit EditorWidget(QWidget *parent = nullptr);
+    ~EditorWidget();
+    
+    // Restored tabs are placeholders that neither read their file nor build
+    // a highlighter until the tab is activated
+    void setPending(const PendingTab &tab);
+    PendingTab takePending();
+    bool isPending() const { return pending; }
     
     bool loadFile(const QString &fileName);
+    bool openLargeFile(const QString &fileName);
+    bool openHexView(const QString &fileName);
+    bool isLargeFileView() const { return largeFileView != nullptr; }
+    bool isLoading() const { return loading; }
+    bool isSaving() const { return saving; }
+    
+    // Fills the document with text that is not an edit: the contents of a
+    // file being opened or of a restored buffer. The session store does
+    // not journal changes made while this is going on.
+    void fillDocument(const QString &text);
+    bool isFillingDocument() const { return fillingDocument; }
+    EncodingDetector::Encoding encoding() const { return fileEncoding; }
+    LineEndingScanner::Style lineEnding() const { return lineEndingStyle; }
+    bool hasMixedLineEndings() const { return mixedLineEndings; }
+    bool isCompressed() const { return compressed; }
+    
+    // Follow mode keeps appending whatever is written to the end of the file
+    bool setFollowMode(bool enabled);
+    bool isFollowing() const { return following; }
+    void cancelLoading();
+    
+    // Files at or above this size open in the memory-mapped large file view
+    static qint64 largeFileThreshold();
     bool save();
     bool saveAs();
-    QString currentFile() const { return currentFilePath; }  // Changed from curFile to currentFilePath
-    bool isUntitled() const { return currentFilePath.isEmpty(); }  // Changed from curFile to currentFilePath
+    QString currentFile() const { return pending ? pendingTab.fileName : currentFilePath; }  // Changed from curFile to currentFilePath
+    bool isUntitled() const { return currentFile().isEmpty(); }  // Changed from curFile to currentFilePath
+    QString text() const;
+    int cursorPosition() const;
+    void setCursorPosition(int position);
     bool isModified() const;
     void setModified(bool modified);
     bool maybeSave();
@@ -33,6 +93,9 @@ public:
     // Add accessor method for textEditor
     CodeEditor* editor() const { return textEditor; }
     
+    // Binary files are shown read-only in a hex view instead of the editor
+    HexView *hexViewer() const { return hexView; }
+    
     // Declare edit operation methods
     void undo();
     void redo();
@@ -57,23 +120,114 @@ signals:
     void modificationChanged(bool modified);
     void languageChanged(const QString &language);
     void zoomLevelChanged(int level);
+    void loadFinished();
+    void lineEndingsChanged();
+    void followModeChanged(bool following);
 
 private slots:
     void documentWasModified();
+    void appendLoadedChunk(const QString &text);
+    void pumpPendingChunks();
+    void pumpSaveChunks();
+    void watchedFileChanged(const QString &fileName);
+    void fileChangedOnDisk();
+    void readAppendedData();
+    void reloadFinished();
+    void updateLoadProgress(qint64 bytesRead, qint64 totalBytes);
+    void finishLoading();
+    void loadingFailed(const QString &errorString);
+    void loadingCancelled();
+    void loadingLimitReached();
 
 private:
     CodeEditor *textEditor;
     QVBoxLayout *layout;
+    QHBoxLayout *editorLayout;
+    HexView *hexView;
+    LargeFileView *largeFileView;
+    QScrollBar *largeFileScrollBar;
+    FileLoader *fileLoader;
+    QWidget *loadingBar;
+    QProgressBar *loadingProgress;
+    QLabel *loadingLabel;
+    QPushButton *loadingCancelButton;
+    QTimer *appendTimer;
+    QQueue<QString> pendingChunks;
+    int pendingOffset;
+    bool loading;
+    bool loaderFinished;
+    bool loaderTruncated;
+    bool partiallyLoaded;
+    FileSaver *fileSaver;
+    QTimer *saveTimer;
+    TextEncoder *saveEncoder;
+    QTextBlock saveBlock;
+    qint64 saveOffset;
+    bool saving;
+    bool fillingDocument;
+    EncodingDetector::Encoding fileEncoding;
+    LineEndingScanner::Style lineEndingStyle;
+    bool mixedLineEndings;
+    LineEndingScanner loadedLineEndings;
+    QTimer *changeTimer;
+    bool following;
+    bool followUpdating;
+    bool followHeldCR;
+    bool followWasReadOnly;
+    qint64 followOffset;
+    QDateTime followBirthTime;
+    QScopedPointer<TextDecoder> followDecoder;
+    FileReloader *fileReloader;
+    int reloadRevision;
+    bool reloading;
+    bool reloadPending;
+    qint64 diskSize;
+    QDateTime diskModified;
+    QString watchedPath;
+    bool compressed;
+    bool pending;
+    PendingTab pendingTab;
+    int deferredCursorPosition;
     QString currentFilePath;
     QString currentLang;
     SyntaxHighlighter *highlighter;
     bool usingDarkTheme;
     
     void setupEditor();
+    bool loadCompressedFile(const QString &fileName, CompressedFile::Format format);
+    bool loadTextFile(const QString &fileName, EncodingDetector::Encoding detected);
+    bool startAsyncLoad(const QString &fileName);
+    void beginLoading(const QString &fileName);
+    void stopLoader();
+    void createLoadingBar();
+    void endLoading();
+    void completeLoading();
+    void applyLineEndings(const LineEndingScanner &lineEndings);
+    void rememberDiskState();
+    void startReload();
+    void applyReload();
+    void finishReload();
     bool saveFile(const QString &fileName);
+    QByteArray nextSaveChunk();
+    void largeFileLost(const QString &fileName);
     void setCurrentFile(const QString &fileName);
     void updateHighlighter();
     void initEditor(); // Add this declaration for the initEditor() method
+    
+    // Files above this size are read and decoded on a background thread
+    static const qint64 AsyncLoadThreshold = 2 * 1024 * 1024;
+    
+    // Progressive loading: the first screen is painted before the rest of
+    // the file is appended in slices that fit in a small time budget
+    static const int FirstScreenChars = 256 * 1024;
+    static const int AppendSliceChars = 64 * 1024;
+    static const int AppendBudgetMs = 8;
+    
+    // Size of the slices handed to the background writer when saving
+    static const int SaveChunkSize = 1024 * 1024;
+    
+    // Delay used to batch change notifications for the file on disk
+    static const int ChangeBatchMs = 50;
 };
 
 #endif // EDITORWIDGET_H
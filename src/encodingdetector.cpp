@@ -0,0 +1,272 @@
+#include "encodingdetector.h"
+#include <QFile>
+#include <QtAlgorithms>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NOTEPADX_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define NOTEPADX_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// Length of the run of ASCII bytes at the start of p
+qint64 asciiPrefixLength(const uchar *p, qint64 n)
+{
+    qint64 i = 0;
+#if defined(NOTEPADX_SSE2)
+    for (; i + 16 <= n; i += 16) {
+        int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i)));
+        if (mask)
+            return i + qCountTrailingZeroBits(static_cast<quint32>(mask));
+    }
+#elif defined(NOTEPADX_NEON)
+    for (; i + 16 <= n; i += 16) {
+        if (vmaxvq_u8(vld1q_u8(p + i)) >= 0x80)
+            break;
+    }
+#else
+    for (; i + 8 <= n; i += 8) {
+        quint64 word;
+        std::memcpy(&word, p + i, sizeof(word));
+        if (word & Q_UINT64_C(0x8080808080808080))
+            break;
+    }
+#endif
+    while (i < n && p[i] < 0x80)
+        ++i;
+    return i;
+}
+
+// NUL bytes at even and odd offsets; UTF-16 text has them on one side only
+void countNuls(const uchar *p, qint64 n, qint64 *even, qint64 *odd)
+{
+    qint64 i = 0;
+#if defined(NOTEPADX_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        quint32 mask = static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, zero)));
+        if (mask) {
+            *even += qPopulationCount(mask & 0x5555u);
+            *odd += qPopulationCount(mask & 0xAAAAu);
+        }
+    }
+#elif defined(NOTEPADX_NEON)
+    const uint8x16_t zero = vdupq_n_u8(0);
+    for (; i + 32 <= n; i += 32) {
+        // De-interleaving load puts even bytes in val[0] and odd ones in val[1]
+        uint8x16x2_t bytes = vld2q_u8(p + i);
+        *even += vaddvq_u8(vshrq_n_u8(vceqq_u8(bytes.val[0], zero), 7));
+        *odd += vaddvq_u8(vshrq_n_u8(vceqq_u8(bytes.val[1], zero), 7));
+    }
+#endif
+    for (; i < n; ++i) {
+        if (p[i] == 0)
+            ++*((i & 1) ? odd : even);
+    }
+}
+
+// A sequence cut off by the end of a truncated sample is not an error
+bool isValidUtf8(const uchar *p, qint64 n, bool truncated)
+{
+    qint64 i = 0;
+    while (i < n) {
+        i += asciiPrefixLength(p + i, n - i);
+        if (i >= n)
+            break;
+
+        uchar lead = p[i];
+        int length;
+        if (lead >= 0xC2 && lead <= 0xDF)
+            length = 2;
+        else if ((lead & 0xF0) == 0xE0)
+            length = 3;
+        else if (lead >= 0xF0 && lead <= 0xF4)
+            length = 4;
+        else
+            return false;
+
+        if (i + length > n)
+            return truncated;
+
+        uint codePoint = lead & (0x7F >> length);
+        for (int k = 1; k < length; ++k) {
+            if ((p[i + k] & 0xC0) != 0x80)
+                return false;
+            codePoint = (codePoint << 6) | (p[i + k] & 0x3F);
+        }
+
+        // Reject overlong forms, surrogates and values past U+10FFFF
+        if (length == 3 && (codePoint < 0x800 || (codePoint >= 0xD800 && codePoint <= 0xDFFF)))
+            return false;
+        if (length == 4 && (codePoint < 0x10000 || codePoint > 0x10FFFF))
+            return false;
+
+        i += length;
+    }
+    return true;
+}
+
+} // namespace
+
+EncodingDetector::Encoding EncodingDetector::detect(const char *data, qint64 size, bool truncated)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(data);
+
+    if (size >= 3 && p[0] == 0xEF && p[1] == 0xBB && p[2] == 0xBF)
+        return Utf8WithBom;
+    if (size >= 2 && p[0] == 0xFF && p[1] == 0xFE)
+        return Utf16LE;
+    if (size >= 2 && p[0] == 0xFE && p[1] == 0xFF)
+        return Utf16BE;
+
+    qint64 evenNuls = 0;
+    qint64 oddNuls = 0;
+    countNuls(p, size, &evenNuls, &oddNuls);
+
+    // Mostly-ASCII UTF-16 without a BOM has a NUL in every other byte
+    qint64 pairs = size / 2;
+    if (pairs > 0 && oddNuls > pairs * 2 / 5 && evenNuls < pairs / 20)
+        return Utf16LE;
+    if (pairs > 0 && evenNuls > pairs * 2 / 5 && oddNuls < pairs / 20)
+        return Utf16BE;
+
+    // Text files do not contain NUL bytes
+    if (evenNuls + oddNuls > 0)
+        return Binary;
+
+    return isValidUtf8(p, size, truncated) ? Utf8 : Latin1;
+}
+
+EncodingDetector::Encoding EncodingDetector::detectFile(const QString &fileName)
+{
+    // Files that cannot be read are reported by whoever opens them next
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return Utf8;
+
+    return detectDevice(&file);
+}
+
+EncodingDetector::Encoding EncodingDetector::detectDevice(QIODevice *device)
+{
+    QByteArray sample = device->read(SampleSize);
+    return detect(sample.constData(), sample.size(), !device->atEnd());
+}
+
+QString EncodingDetector::name(Encoding encoding)
+{
+    switch (encoding) {
+    case Utf8:
+        return QStringLiteral("UTF-8");
+    case Utf8WithBom:
+        return QStringLiteral("UTF-8 with BOM");
+    case Utf16LE:
+        return QStringLiteral("UTF-16 LE");
+    case Utf16BE:
+        return QStringLiteral("UTF-16 BE");
+    case Latin1:
+        return QStringLiteral("ISO-8859-1");
+    case Binary:
+        return QStringLiteral("Binary");
+    }
+    return QString();
+}
+
+QByteArray EncodingDetector::byteOrderMark(Encoding encoding)
+{
+    switch (encoding) {
+    case Utf8WithBom:
+        return QByteArray("\xEF\xBB\xBF");
+    case Utf16LE:
+        return QByteArray("\xFF\xFE");
+    case Utf16BE:
+        return QByteArray("\xFE\xFF");
+    default:
+        return QByteArray();
+    }
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+namespace {
+
+QStringConverter::Encoding converterEncoding(EncodingDetector::Encoding encoding)
+{
+    switch (encoding) {
+    case EncodingDetector::Utf16LE:
+        return QStringConverter::Utf16LE;
+    case EncodingDetector::Utf16BE:
+        return QStringConverter::Utf16BE;
+    case EncodingDetector::Latin1:
+    case EncodingDetector::Binary:
+        return QStringConverter::Latin1;
+    default:
+        return QStringConverter::Utf8;
+    }
+}
+
+} // namespace
+
+TextDecoder::TextDecoder(EncodingDetector::Encoding encoding)
+    : m_decoder(converterEncoding(encoding))
+{
+}
+
+QString TextDecoder::decode(const QByteArray &bytes)
+{
+    return m_decoder.decode(bytes);
+}
+
+TextEncoder::TextEncoder(EncodingDetector::Encoding encoding)
+    : m_encoder(converterEncoding(encoding))
+{
+}
+
+QByteArray TextEncoder::encode(const QString &text)
+{
+    return m_encoder.encode(text);
+}
+#else
+namespace {
+
+QTextCodec *codecFor(EncodingDetector::Encoding encoding)
+{
+    switch (encoding) {
+    case EncodingDetector::Utf16LE:
+        return QTextCodec::codecForName("UTF-16LE");
+    case EncodingDetector::Utf16BE:
+        return QTextCodec::codecForName("UTF-16BE");
+    case EncodingDetector::Latin1:
+    case EncodingDetector::Binary:
+        return QTextCodec::codecForName("ISO-8859-1");
+    default:
+        return QTextCodec::codecForName("UTF-8");
+    }
+}
+
+} // namespace
+
+TextDecoder::TextDecoder(EncodingDetector::Encoding encoding)
+    : m_decoder(codecFor(encoding)->makeDecoder())
+{
+}
+
+QString TextDecoder::decode(const QByteArray &bytes)
+{
+    return m_decoder->toUnicode(bytes);
+}
+
+TextEncoder::TextEncoder(EncodingDetector::Encoding encoding)
+    : m_encoder(codecFor(encoding)->makeEncoder(QTextCodec::IgnoreHeader))
+{
+}
+
+QByteArray TextEncoder::encode(const QString &text)
+{
+    return m_encoder->fromUnicode(text);
+}
+#endif
@@ -0,0 +1,77 @@
+#ifndef ENCODINGDETECTOR_H
+#define ENCODINGDETECTOR_H
+
+#include <QString>
+#include <QByteArray>
+#include <QIODevice>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QStringDecoder>
+#include <QStringEncoder>
+#else
+#include <QTextCodec>
+#include <memory>
+#endif
+
+// Guesses the encoding of a file from the first few megabytes of it:
+// byte order marks, UTF-8 validity and the density and position of NUL
+// bytes, which tell UTF-16 text and binary data apart from 8-bit text.
+// The hot loops use SSE2 or NEON where available.
+class EncodingDetector
+{
+public:
+    enum Encoding {
+        Utf8,
+        Utf8WithBom,
+        Utf16LE,
+        Utf16BE,
+        Latin1,
+        Binary
+    };
+
+    static Encoding detect(const char *data, qint64 size, bool truncated);
+    static Encoding detectFile(const QString &fileName);
+    static Encoding detectDevice(QIODevice *device);
+
+    static QString name(Encoding encoding);
+    static QByteArray byteOrderMark(Encoding encoding);
+
+    // Encodings where a '\n' byte is always a line break, so files can be
+    // scanned byte-wise by the large file view
+    static bool isByteOriented(Encoding encoding) { return encoding != Utf16LE && encoding != Utf16BE; }
+
+private:
+    static const qint64 SampleSize = 4 * 1024 * 1024;
+};
+
+// Stateful decoder for one of the detected encodings, so multi-byte
+// sequences split across chunks decode correctly
+class TextDecoder
+{
+public:
+    explicit TextDecoder(EncodingDetector::Encoding encoding);
+    QString decode(const QByteArray &bytes);
+
+private:
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    QStringDecoder m_decoder;
+#else
+    std::unique_ptr<QTextDecoder> m_decoder;
+#endif
+};
+
+// Stateful encoder counterpart; never writes a byte order mark itself
+class TextEncoder
+{
+public:
+    explicit TextEncoder(EncodingDetector::Encoding encoding);
+    QByteArray encode(const QString &text);
+
+private:
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    QStringEncoder m_encoder;
+#else
+    std::unique_ptr<QTextEncoder> m_encoder;
+#endif
+};
+
+#endif // ENCODINGDETECTOR_H
@@ -0,0 +1,138 @@
+#include "fileloader.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QScopedPointer>
+
+FileLoader::FileLoader(QObject *parent)
+    : QThread(parent), m_firstChunkSize(0),
+      m_encoding(EncodingDetector::Utf8), m_compressed(false), m_sizeLimit(0), m_freeSlots(MaxChunksInFlight)
+{
+}
+
+FileLoader::~FileLoader()
+{
+    cancel();
+    wait();
+}
+
+void FileLoader::load(const QString &fileName, qint64 firstChunkSize)
+{
+    m_fileName = fileName;
+    m_firstChunkSize = firstChunkSize;
+    m_lineEndings = LineEndingScanner();
+    start();
+}
+
+void FileLoader::cancel()
+{
+    requestInterruption();
+}
+
+void FileLoader::chunkConsumed()
+{
+    m_freeSlots.release();
+}
+
+bool FileLoader::waitForFreeSlot()
+{
+    // Poll so a cancel request is noticed even when the GUI stops consuming
+    while (!m_freeSlots.tryAcquire(1, 50)) {
+        if (isInterruptionRequested())
+            return false;
+    }
+    return true;
+}
+
+void FileLoader::run()
+{
+    // Compressed files are inflated as they are read; progress is then
+    // measured on the compressed input
+    QScopedPointer<QIODevice> file;
+    CompressedFile *compressedFile = nullptr;
+    if (m_compressed)
+        file.reset(compressedFile = new CompressedFile(m_fileName));
+    else
+        file.reset(new QFile(m_fileName));
+    auto position = [&]() { return compressedFile ? compressedFile->compressedPos() : file->pos(); };
+
+    // Binary mode: line endings are normalized and recorded by m_lineEndings
+    if (!file->open(QIODevice::ReadOnly)) {
+        emit loadFailed(file->errorString());
+        return;
+    }
+
+    const qint64 totalBytes = QFileInfo(m_fileName).size();
+
+    // The byte order mark is not part of the text
+    TextDecoder decoder(m_encoding);
+    file->read(EncodingDetector::byteOrderMark(m_encoding).size());
+
+    QString pending;
+    qint64 readSize = m_firstChunkSize > 0 ? qMin(m_firstChunkSize, ChunkSize) : ChunkSize;
+    qint64 bytesDecoded = 0;
+    bool limitReached = false;
+    while (!file->atEnd()) {
+        if (isInterruptionRequested()) {
+            emit loadCancelled();
+            return;
+        }
+
+        // What was decoded so far is still handed over below
+        if (m_sizeLimit > 0 && bytesDecoded >= m_sizeLimit) {
+            limitReached = true;
+            break;
+        }
+
+        QByteArray bytes(static_cast<int>(readSize), Qt::Uninitialized);
+        qint64 bytesRead = file->read(bytes.data(), readSize);
+        readSize = ChunkSize;
+        if (bytesRead < 0) {
+            emit loadFailed(file->errorString());
+            return;
+        }
+        bytes.resize(static_cast<int>(bytesRead));
+        bytesDecoded += bytesRead;
+
+        pending += decoder.decode(bytes);
+
+        // Hand over whole lines so every append ends on a block boundary,
+        // unless a single line is so long that it has to be split anyway
+        int splitAt = pending.lastIndexOf(QLatin1Char('\n')) + 1;
+        if (splitAt == 0 && pending.size() < ChunkSize)
+            continue;
+        if (splitAt == 0)
+            splitAt = pending.size();
+        if (pending.at(splitAt - 1) == QLatin1Char('\r'))
+            --splitAt;  // Keep a CR with the LF that may follow it
+        if (splitAt == 0)
+            continue;
+
+        QString text = pending.left(splitAt);
+        pending.remove(0, splitAt);
+        m_lineEndings.scan(text);
+
+        if (!waitForFreeSlot()) {
+            emit loadCancelled();
+            return;
+        }
+        emit chunkReady(text);
+        emit progress(position(), totalBytes);
+    }
+
+    if (!pending.isEmpty()) {
+        m_lineEndings.scan(pending);
+        if (!waitForFreeSlot()) {
+            emit loadCancelled();
+            return;
+        }
+        emit chunkReady(pending);
+    }
+
+    if (limitReached) {
+        emit loadLimitReached();
+        return;
+    }
+
+    emit progress(totalBytes, totalBytes);
+    emit loadFinished();
+}
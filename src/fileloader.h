@@ -0,0 +1,67 @@
+#ifndef FILELOADER_H
+#define FILELOADER_H
+
+#include <QThread>
+#include <QString>
+#include <QSemaphore>
+#include "encodingdetector.h"
+#include "lineendings.h"
+#include "compressedfile.h"
+
+// Reads and decodes a text file on a worker thread and hands the result to
+// the GUI thread in line-aligned chunks. At most a few chunks are in flight
+// at any time, so a slow consumer never makes the loader buffer the file.
+class FileLoader : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit FileLoader(QObject *parent = nullptr);
+    ~FileLoader();
+
+    // The first read can be smaller than the rest so the head of the file
+    // reaches the screen before the bulk of it has been decoded
+    void load(const QString &fileName, qint64 firstChunkSize = 0);
+    void cancel();
+
+    // Must be called by the receiver once it has consumed a chunkReady()
+    void chunkConsumed();
+
+    QString fileName() const { return m_fileName; }
+    void setEncoding(EncodingDetector::Encoding encoding) { m_encoding = encoding; }
+    void setCompressed(bool compressed) { m_compressed = compressed; }
+
+    // Stop after this many bytes have been read and emit loadLimitReached()
+    // instead of loadFinished(); zero reads the whole file
+    void setSizeLimit(qint64 bytes) { m_sizeLimit = bytes; }
+
+    // Terminators of the text handed out so far; complete after loadFinished()
+    const LineEndingScanner &lineEndings() const { return m_lineEndings; }
+
+signals:
+    void chunkReady(const QString &text);
+    void progress(qint64 bytesRead, qint64 totalBytes);
+    void loadFinished();
+    void loadFailed(const QString &errorString);
+    void loadCancelled();
+    void loadLimitReached();
+
+protected:
+    void run() override;
+
+private:
+    QString m_fileName;
+    qint64 m_firstChunkSize;
+    EncodingDetector::Encoding m_encoding;
+    bool m_compressed;
+    qint64 m_sizeLimit;
+    LineEndingScanner m_lineEndings;
+    QSemaphore m_freeSlots;
+
+    bool waitForFreeSlot();
+
+    static const int MaxChunksInFlight = 4;
+    static const qint64 ChunkSize = 1024 * 1024;
+};
+
+#endif // FILELOADER_H
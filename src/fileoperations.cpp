@@ -2,6 +2,7 @@
 #include "mainwindow.h"
 #include "editorwidget.h"
 #include "codeeditor.h" 
+#include "compressedfile.h"
 #include <QTabWidget>
 #include <QFileDialog>
 #include <QFileInfo>
@@ -14,7 +15,7 @@
 #include <QDebug>
 
 FileOperations::FileOperations(MainWindow *parent)
-    : QObject(parent), m_mainWindow(parent), m_untitledCount(0), 
+    : QObject(parent), m_mainWindow(parent), m_untitledCount(0), m_restoringSession(false), m_sessionStore(nullptr),
       m_recentFilesMenu(nullptr), m_isDarkThemeActive(false), m_isWordWrapEnabled(false)
 {
     // Initialize member variables with values from MainWindow
@@ -24,6 +25,11 @@ FileOperations::FileOperations(MainWindow *parent)
         return;
     }
     
+    m_sessionStore = new SessionStore(m_tabWidget, this);
+    
+    // Restored tabs are only loaded once they are looked at
+    connect(m_tabWidget, &QTabWidget::currentChanged, this, &FileOperations::materializeTab);
+    
     // Safer way to get menus - only do this if menus exist
     QMenuBar* menuBar = parent->menuBar();
     if (!menuBar) {
@@ -55,15 +61,9 @@ FileOperations::FileOperations(MainWindow *parent)
     m_isDarkThemeActive = settings.value("darkTheme", false).toBool();
     m_isWordWrapEnabled = settings.value("wordWrap", false).toBool();
     
-    // Load recent files from settings
-    QStringList validRecentFiles;
+    // Load recent files from settings; checking that they still exist
+    // waits until after startup
     recentFiles = settings.value("recentFiles").toStringList();
-    for (const QString &filePath : recentFiles) {
-        if (QFile::exists(filePath)) {
-            validRecentFiles.append(filePath);
-        }
-    }
-    recentFiles = validRecentFiles;
     
     // Only update menu if we found it
     if (m_recentFilesMenu) {
@@ -127,6 +127,10 @@ EditorWidget* FileOperations::createEditor()
     // Apply current word wrap setting
     editor->setWordWrapMode(m_isWordWrapEnabled ? QTextOption::WrapAtWordBoundaryOrAnywhere : QTextOption::NoWrap);
 
+    if (m_sessionStore) {
+        m_sessionStore->track(editor);
+    }
+
     return editor;
 }
 
@@ -188,8 +192,9 @@ bool FileOperations::openFileHelper(const QString &fileName)
         currentEditorWidget = qobject_cast<EditorWidget *>(m_tabWidget->widget(currentIndex));
     }
 
-    if (currentEditorWidget && currentEditorWidget->isUntitled() && !currentEditorWidget->isModified()) {
-        if (currentEditorWidget->loadFile(fileName)) {
+    if (currentEditorWidget && currentEditorWidget->isUntitled() && !currentEditorWidget->isModified()
+        && !currentEditorWidget->isSaving()) {
+        if (loadFileIntoEditor(currentEditorWidget, fileName)) {
             m_mainWindow->statusBar()->showMessage(QObject::tr("File loaded"), 2000);
             return true;
         }
@@ -197,7 +202,7 @@ bool FileOperations::openFileHelper(const QString &fileName)
     }
 
     EditorWidget *editor = createEditor();
-    if (editor->loadFile(fileName)) {
+    if (loadFileIntoEditor(editor, fileName)) {
         int index = m_tabWidget->addTab(editor, QFileInfo(fileName).fileName());
         m_tabWidget->setCurrentIndex(index);
 
@@ -233,6 +238,23 @@ bool FileOperations::openFileHelper(const QString &fileName)
     }
 }
 
+bool FileOperations::loadFileIntoEditor(EditorWidget *editor, const QString &fileName)
+{
+    // Compressed files are recognized by their magic bytes and streamed
+    // through a decompressor, however large they are on disk
+    if (CompressedFile::detect(fileName) != CompressedFile::None) {
+        return editor->loadFile(fileName);
+    }
+    
+    // Huge files are memory mapped and paged into the viewport instead of
+    // being decoded into a QTextDocument, which would run out of memory
+    if (QFileInfo(fileName).size() >= EditorWidget::largeFileThreshold()) {
+        return editor->openLargeFile(fileName);
+    }
+    
+    return editor->loadFile(fileName);
+}
+
 bool FileOperations::saveFile()
 {
     if (!ensureHasOpenTab())
@@ -293,7 +315,7 @@ bool FileOperations::maybeSaveAll()
 {
     for (int i = 0; i < m_tabWidget->count(); ++i) {
         EditorWidget *editor = qobject_cast<EditorWidget *>(m_tabWidget->widget(i));
-        if (editor && editor->isModified()) {
+        if (editor && (editor->isModified() || editor->isSaving())) {
             m_tabWidget->setCurrentIndex(i);
             if (!editor->maybeSave()) {
                 return false;
@@ -329,6 +351,21 @@ void FileOperations::clearRecentFiles()
     updateRecentFilesMenu();
 }
 
+void FileOperations::validateRecentFiles()
+{
+    QStringList validRecentFiles;
+    for (const QString &filePath : recentFiles) {
+        if (QFile::exists(filePath)) {
+            validRecentFiles.append(filePath);
+        }
+    }
+    
+    if (validRecentFiles.size() != recentFiles.size()) {
+        recentFiles = validRecentFiles;
+        updateRecentFilesMenu();
+    }
+}
+
 void FileOperations::updateRecentFilesMenu()
 {
     if (!m_recentFilesMenu)
@@ -358,76 +395,87 @@ void FileOperations::updateRecentFilesMenu()
 
 void FileOperations::saveSession()
 {
-    QSettings settings("NotepadX", "Editor");
-    QStringList openFiles;
-    int currentIndex = m_tabWidget->currentIndex();
+    if (!m_sessionStore) {
+        return;
+    }
     
-    settings.beginWriteArray("openFiles");
-    for (int i = 0; i < m_tabWidget->count(); ++i) {
-        EditorWidget *editor = qobject_cast<EditorWidget *>(m_tabWidget->widget(i));
-        if (editor) {
-            settings.setArrayIndex(i);
-            QString filePath = editor->currentFile();
-            settings.setValue("filePath", filePath);
-            settings.setValue("isUntitled", filePath.isEmpty());
-            if (filePath.isEmpty()) {
-                // For untitled files, save content to restore
-                settings.setValue("content", editor->editor()->toPlainText());
-            }
-            settings.setValue("language", editor->currentLanguage());
-            settings.setValue("zoomLevel", editor->getCurrentZoomLevel());
-        }
+    // Untitled buffers were written in the background while editing, so
+    // this is normally just the tab index
+    m_sessionStore->save(true);
+    
+    // Drop the session arrays older versions kept in the settings file
+    QSettings settings("NotepadX", "Editor");
+    settings.remove("openFiles");
+    settings.remove("activeTab");
+}
+
+bool FileOperations::readLegacySession(QVector<SessionStore::Tab> *tabs, int *activeTab)
+{
+    QSettings settings("NotepadX", "Editor");
+    int size = settings.beginReadArray("openFiles");
+    for (int i = 0; i < size; ++i) {
+        settings.setArrayIndex(i);
+        SessionStore::Tab tab;
+        tab.filePath = settings.value("filePath").toString();
+        tab.untitled = settings.value("isUntitled").toBool();
+        tab.text = tab.untitled ? settings.value("content").toString() : QString();
+        tab.language = settings.value("language").toString();
+        tab.zoomLevel = settings.value("zoomLevel", 0).toInt();
+        tab.cursorPosition = settings.value("cursorPosition", 0).toInt();
+        tabs->append(tab);
     }
     settings.endArray();
     
-    settings.setValue("activeTab", currentIndex);
+    *activeTab = settings.value("activeTab", 0).toInt();
+    return size > 0;
 }
 
 void FileOperations::restoreSession()
 {
-    QSettings settings("NotepadX", "Editor");
-    int size = settings.beginReadArray("openFiles");
+    QVector<SessionStore::Tab> tabs;
+    int activeTab = 0;
+    if (m_sessionStore && !m_sessionStore->read(&tabs, &activeTab)) {
+        readLegacySession(&tabs, &activeTab);
+    }
     
     // Don't create default tab if we're going to restore files
-    if (size > 0) {
+    if (!tabs.isEmpty()) {
         // Remove the default tab if it exists and is empty/untitled
         if (m_tabWidget->count() == 1) {
             EditorWidget *editor = qobject_cast<EditorWidget *>(m_tabWidget->widget(0));
-            if (editor && editor->isUntitled() && !editor->isModified()) {
+            if (editor && editor->isUntitled() && !editor->isModified() && !editor->isSaving()) {
                 m_tabWidget->removeTab(0);
                 delete editor;
             }
         }
         
         // Make sure we have the latest word wrap setting
+        QSettings settings("NotepadX", "Editor");
         m_isWordWrapEnabled = settings.value("wordWrap", false).toBool();
         QTextOption::WrapMode mode = m_isWordWrapEnabled ? 
             QTextOption::WrapAtWordBoundaryOrAnywhere : QTextOption::NoWrap;
-            
-        for (int i = 0; i < size; ++i) {
-            settings.setArrayIndex(i);
-            QString filePath = settings.value("filePath").toString();
-            bool isUntitled = settings.value("isUntitled").toBool();
-            QString language = settings.value("language").toString();
-            int zoomLevel = settings.value("zoomLevel", 0).toInt();
+        
+        // Tabs are only created here; reading files, untitled buffers and
+        // building highlighters waits until each tab is first activated
+        m_restoringSession = true;
+        for (const SessionStore::Tab &saved : tabs) {
+            QString filePath = saved.filePath;
+            bool isUntitled = saved.untitled;
             
             EditorWidget *editor = createEditor();
             
-            if (!isUntitled && !filePath.isEmpty() && QFile::exists(filePath)) {
-                // Load existing file
-                editor->loadFile(filePath);
-            } else if (isUntitled) {
-                // Restore content for untitled files
-                QString content = settings.value("content").toString();
-                editor->editor()->setPlainText(content);
+            EditorWidget::PendingTab tab;
+            tab.fileName = isUntitled ? QString() : filePath;
+            tab.text = saved.text;
+            tab.textBlob = saved.blob;
+            tab.language = saved.language;
+            tab.cursorPosition = saved.cursorPosition;
+            editor->setPending(tab);
+            editor->setZoomLevel(saved.zoomLevel);
+            if (!saved.blob.isEmpty()) {
+                m_sessionStore->restored(editor, saved.blob);
             }
             
-            // Set language and zoom level
-            if (!language.isEmpty()) {
-                editor->setLanguage(language);
-            }
-            editor->setZoomLevel(zoomLevel);
-            
             // Explicitly set word wrap mode
             editor->setWordWrapMode(mode);
             
@@ -466,13 +514,45 @@ void FileOperations::restoreSession()
             }
         }
         
-        // Select previously active tab
-        int activeTab = settings.value("activeTab", 0).toInt();
+        m_restoringSession = false;
+        
+        // Select previously active tab, which is the only one loaded now
         if (activeTab >= 0 && activeTab < m_tabWidget->count()) {
             m_tabWidget->setCurrentIndex(activeTab);
         }
+        materializeTab(m_tabWidget->currentIndex());
     }
-    settings.endArray();
+    
+    QMetaObject::invokeMethod(m_mainWindow, "connectEditorSignals");
+    QMetaObject::invokeMethod(m_mainWindow, "updateLanguageMenu");
+    QMetaObject::invokeMethod(m_mainWindow, "updateStatusBar");
+}
+
+void FileOperations::materializeTab(int index)
+{
+    if (m_restoringSession || index < 0)
+        return;
+    
+    EditorWidget *editor = qobject_cast<EditorWidget *>(m_tabWidget->widget(index));
+    if (!editor || !editor->isPending())
+        return;
+    
+    EditorWidget::PendingTab tab = editor->takePending();
+    if (!tab.fileName.isEmpty()) {
+        if (QFile::exists(tab.fileName)) {
+            loadFileIntoEditor(editor, tab.fileName);
+        }
+    } else if (!tab.textBlob.isEmpty()) {
+        m_sessionStore->loadInto(editor, tab.textBlob);
+    } else {
+        editor->fillDocument(tab.text);
+    }
+    
+    // Loading already picked a highlighter from the file name
+    if (!tab.language.isEmpty() && tab.language != editor->currentLanguage()) {
+        editor->setLanguage(tab.language);
+    }
+    editor->setCursorPosition(tab.cursorPosition);
     
     QMetaObject::invokeMethod(m_mainWindow, "connectEditorSignals");
     QMetaObject::invokeMethod(m_mainWindow, "updateLanguageMenu");
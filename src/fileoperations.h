@@ -5,6 +5,8 @@
 #include <QString>
 #include <QStringList>
 #include <QTabWidget>
+#include <QVector>
+#include "sessionstore.h"
 
 class MainWindow;
 class EditorWidget;
@@ -43,6 +45,9 @@ public slots:
     void openRecentFile(const QString &filePath);
     void clearRecentFiles();
     void updateRecentFilesMenu();
+    
+    // Drops recent files that no longer exist; kept off the startup path
+    void validateRecentFiles();
 
     // Getters
     QStringList getRecentFiles() const { return recentFiles; }    // Create editor (moved from MainWindow)
@@ -50,13 +55,24 @@ public slots:
     
     // Ensure at least one tab is open
     bool ensureHasOpenTab();
+    
+    // Turns a restored placeholder tab into a loaded one
+    void materializeTab(int index);
 
 private:
+    // Picks the regular editor or the large file viewer based on file size
+    bool loadFileIntoEditor(EditorWidget *editor, const QString &fileName);
+
+    // Session format used before the session store, read once on upgrade
+    bool readLegacySession(QVector<SessionStore::Tab> *tabs, int *activeTab);
+
     MainWindow *m_mainWindow;
     QTabWidget *m_tabWidget;
     QMenu *m_recentFilesMenu;
     QStringList recentFiles;
     int m_untitledCount;
+    bool m_restoringSession;
+    SessionStore *m_sessionStore;
 
     // Keep track of theme and word wrap settings
     bool m_isDarkThemeActive;
@@ -0,0 +1,203 @@
+#include "filereloader.h"
+#include <QFile>
+#include <QHash>
+#include <algorithm>
+
+FileReloader::FileReloader(QObject *parent)
+    : QThread(parent), m_defaultStyle(LineEndingScanner::Lf), m_succeeded(false), m_cancelled(false),
+      m_encoding(EncodingDetector::Utf8)
+{
+}
+
+FileReloader::~FileReloader()
+{
+    cancel();
+    wait();
+}
+
+void FileReloader::reload(const QString &fileName, const QString &text, const QVector<quint8> &styles,
+                          LineEndingScanner::Style defaultStyle)
+{
+    // finished() is emitted just before the thread actually ends; make sure
+    // it has, so the inputs below are not written under a running diff
+    wait();
+    m_fileName = fileName;
+    m_oldText = text;
+    m_oldStyles = styles;
+    m_defaultStyle = defaultStyle;
+    m_succeeded = false;
+    m_cancelled = false;
+    m_errorString.clear();
+    start();
+}
+
+void FileReloader::cancel()
+{
+    requestInterruption();
+}
+
+void FileReloader::run()
+{
+    m_hunks.clear();
+    m_lineEndings = LineEndingScanner();
+
+    // The writer may have changed the encoding along with the text
+    m_encoding = EncodingDetector::detectFile(m_fileName);
+    if (m_encoding == EncodingDetector::Binary) {
+        m_errorString = tr("The file no longer contains text");
+        return;
+    }
+
+    QFile file(m_fileName);
+    if (!file.open(QFile::ReadOnly)) {
+        m_errorString = file.errorString();
+        return;
+    }
+    file.seek(EncodingDetector::byteOrderMark(m_encoding).size());
+    QByteArray bytes = file.readAll();
+    if (file.error() != QFileDevice::NoError) {
+        m_errorString = file.errorString();
+        return;
+    }
+
+    TextDecoder decoder(m_encoding);
+    QString text = decoder.decode(bytes);
+    bytes.clear();
+    m_lineEndings.scan(text);
+
+    QStringList newLines = text.split(QLatin1Char('\n'));
+    text.clear();
+    QVector<quint8> newStyles(newLines.size(), NoTerminator);
+    const QVector<LineEndingScanner::Run> &runs = m_lineEndings.runs();
+    for (int i = 0; i < runs.size(); ++i) {
+        int end = static_cast<int>(i + 1 < runs.size() ? runs.at(i + 1).firstLine : m_lineEndings.lineCount());
+        std::fill(newStyles.begin() + runs.at(i).firstLine, newStyles.begin() + end,
+                  static_cast<quint8>(runs.at(i).style));
+    }
+
+    QStringList oldLines = m_oldText.split(QLatin1Char('\n'));
+    m_oldText.clear();
+    QVector<quint8> oldStyles = m_oldStyles;
+    if (oldStyles.size() != oldLines.size())
+        oldStyles.fill(static_cast<quint8>(m_defaultStyle), oldLines.size());
+    oldStyles.last() = NoTerminator;
+
+    m_succeeded = diff(oldLines, oldStyles, newLines, newStyles);
+    m_cancelled = !m_succeeded;
+}
+
+bool FileReloader::diff(const QStringList &oldLines, const QVector<quint8> &oldStyles,
+                        const QStringList &newLines, const QVector<quint8> &newStyles)
+{
+    // A line only matches if its terminator is the same too, so a change of
+    // line endings on disk is picked up like any other edit
+    auto same = [&](int oldLine, int newLine) {
+        return oldStyles.at(oldLine) == newStyles.at(newLine) && oldLines.at(oldLine) == newLines.at(newLine);
+    };
+
+    // Most external edits touch a small part of the file, so the common
+    // head and tail are skipped before running the real diff
+    const int oldCount = oldLines.size();
+    const int newCount = newLines.size();
+    int prefix = 0;
+    while (prefix < oldCount && prefix < newCount && same(prefix, prefix))
+        ++prefix;
+    int suffix = 0;
+    while (suffix < oldCount - prefix && suffix < newCount - prefix
+           && same(oldCount - 1 - suffix, newCount - 1 - suffix))
+        ++suffix;
+
+    const int n = oldCount - prefix - suffix;
+    const int m = newCount - prefix - suffix;
+    auto addHunk = [&](int oldStart, int oldLength, int newStart, int newLength) {
+        Hunk hunk;
+        hunk.oldStart = prefix + oldStart;
+        hunk.oldCount = oldLength;
+        hunk.lines = newLines.mid(prefix + newStart, newLength);
+        hunk.styles = newStyles.mid(prefix + newStart, newLength);
+        m_hunks.append(hunk);
+    };
+    if (n == 0 && m == 0)
+        return true;
+    if (n == 0 || m == 0) {
+        addHunk(0, n, 0, m);
+        return true;
+    }
+
+    // Hashes make the inner loop compare integers for all but matching lines
+    QVector<uint> oldHashes(n);
+    QVector<uint> newHashes(m);
+    for (int i = 0; i < n; ++i)
+        oldHashes[i] = qHash(oldLines.at(prefix + i), oldStyles.at(prefix + i));
+    for (int i = 0; i < m; ++i)
+        newHashes[i] = qHash(newLines.at(prefix + i), newStyles.at(prefix + i));
+    auto equal = [&](int x, int y) {
+        return oldHashes.at(x) == newHashes.at(y) && same(prefix + x, prefix + y);
+    };
+
+    // Myers' O(ND) diff over the remaining lines, keeping each round's
+    // furthest reaching paths for the walk back
+    const int maxD = qMin(n + m, static_cast<int>(MaxEditDistance));
+    const int offset = maxD + 1;
+    QVector<int> v(2 * offset + 1, 0);
+    QVector<QVector<int>> trace;
+    bool found = false;
+    for (int d = 0; d <= maxD && !found; ++d) {
+        if (isInterruptionRequested())
+            return false;
+
+        trace.append(v);
+        for (int k = -d; k <= d; k += 2) {
+            int x = (k == -d || (k != d && v.at(offset + k - 1) < v.at(offset + k + 1)))
+                    ? v.at(offset + k + 1) : v.at(offset + k - 1) + 1;
+            int y = x - k;
+            while (x < n && y < m && equal(x, y)) {
+                ++x;
+                ++y;
+            }
+            v[offset + k] = x;
+            if (x >= n && y >= m) {
+                found = true;
+                break;
+            }
+        }
+    }
+
+    // Too different to be worth it: replace the changed range in one go
+    if (!found) {
+        addHunk(0, n, 0, m);
+        return true;
+    }
+
+    QVector<QPair<int, int>> matches;
+    int x = n;
+    int y = m;
+    for (int d = trace.size() - 1; d >= 0; --d) {
+        const QVector<int> &previous = trace.at(d);
+        int k = x - y;
+        int previousK = (k == -d || (k != d && previous.at(offset + k - 1) < previous.at(offset + k + 1)))
+                        ? k + 1 : k - 1;
+        int previousX = previous.at(offset + previousK);
+        int previousY = previousX - previousK;
+        while (x > previousX && y > previousY) {
+            --x;
+            --y;
+            matches.append(qMakePair(x, y));
+        }
+        x = previousX;
+        y = previousY;
+    }
+    std::reverse(matches.begin(), matches.end());
+    matches.append(qMakePair(n, m));
+
+    // Every gap between two matching lines is one hunk
+    int oldNext = 0;
+    int newNext = 0;
+    for (const QPair<int, int> &match : matches) {
+        if (match.first > oldNext || match.second > newNext)
+            addHunk(oldNext, match.first - oldNext, newNext, match.second - newNext);
+        oldNext = match.first + 1;
+        newNext = match.second + 1;
+    }
+    return true;
+}
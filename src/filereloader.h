@@ -0,0 +1,77 @@
+#ifndef FILERELOADER_H
+#define FILERELOADER_H
+
+#include <QThread>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "encodingdetector.h"
+#include "lineendings.h"
+
+// Re-reads a file that changed on disk and works out, on a worker thread,
+// which lines differ from the text currently in the editor. The result is
+// a list of hunks small enough to be applied as one undoable edit instead
+// of replacing the whole document.
+class FileReloader : public QThread
+{
+    Q_OBJECT
+
+public:
+    // Lines [oldStart, oldStart + oldCount) of the document are replaced by
+    // lines, each with the terminator it has on disk
+    struct Hunk {
+        int oldStart;
+        int oldCount;
+        QStringList lines;
+        QVector<quint8> styles;
+    };
+
+    // Style of the last line, which has no terminator
+    static const quint8 NoTerminator = 0xff;
+
+    explicit FileReloader(QObject *parent = nullptr);
+    ~FileReloader();
+
+    // text is the document as '\n' separated lines; styles holds the
+    // terminator of each line, or is empty when all lines use defaultStyle
+    void reload(const QString &fileName, const QString &text, const QVector<quint8> &styles,
+                LineEndingScanner::Style defaultStyle);
+    void cancel();
+
+    QString fileName() const { return m_fileName; }
+
+    // The outcome is read once finished() has been emitted, so the next
+    // reload() can never start while the thread is still running
+    bool succeeded() const { return m_succeeded; }
+    bool wasCancelled() const { return m_cancelled; }
+    QString errorString() const { return m_errorString; }
+
+    // Valid when succeeded()
+    const QVector<Hunk> &hunks() const { return m_hunks; }
+    EncodingDetector::Encoding encoding() const { return m_encoding; }
+    const LineEndingScanner &lineEndings() const { return m_lineEndings; }
+
+protected:
+    void run() override;
+
+private:
+    QString m_fileName;
+    QString m_oldText;
+    QVector<quint8> m_oldStyles;
+    LineEndingScanner::Style m_defaultStyle;
+    QString m_errorString;
+    bool m_succeeded;
+    bool m_cancelled;
+
+    QVector<Hunk> m_hunks;
+    EncodingDetector::Encoding m_encoding;
+    LineEndingScanner m_lineEndings;
+
+    bool diff(const QStringList &oldLines, const QVector<quint8> &oldStyles,
+              const QStringList &newLines, const QVector<quint8> &newStyles);
+
+    // Beyond this many changed lines the changed range is replaced as a whole
+    static const int MaxEditDistance = 1000;
+};
+
+#endif // FILERELOADER_H
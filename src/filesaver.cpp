@@ -0,0 +1,176 @@
+#include "filesaver.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QTemporaryFile>
+#include <QMutexLocker>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#include <cstdio>
+#include <cerrno>
+#endif
+
+namespace {
+
+bool syncToDisk(QFileDevice &file)
+{
+#ifdef Q_OS_WIN
+    HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(file.handle()));
+    return handle != INVALID_HANDLE_VALUE && FlushFileBuffers(handle);
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+// Atomically replaces target with source; both are on the same volume
+bool replaceFile(const QString &source, const QString &target, QString *errorString)
+{
+#ifdef Q_OS_WIN
+    if (MoveFileExW(reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(source).utf16()),
+                    reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(target).utf16()),
+                    MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+        return true;
+    *errorString = qt_error_string(static_cast<int>(GetLastError()));
+    return false;
+#else
+    if (::rename(QFile::encodeName(source).constData(), QFile::encodeName(target).constData()) == 0)
+        return true;
+    *errorString = qt_error_string(errno);
+    return false;
+#endif
+}
+
+} // namespace
+
+FileSaver::FileSaver(QObject *parent)
+    : QThread(parent), m_syncToDisk(true), m_succeeded(false), m_cancelled(false),
+      m_freeSlots(MaxChunksInFlight), m_usedSlots(0)
+{
+}
+
+FileSaver::~FileSaver()
+{
+    cancel();
+    wait();
+}
+
+void FileSaver::save(const QString &fileName)
+{
+    m_fileName = fileName;
+    m_succeeded = false;
+    m_cancelled = false;
+    m_errorString.clear();
+    start();
+}
+
+void FileSaver::cancel()
+{
+    requestInterruption();
+}
+
+void FileSaver::write(const QByteArray &bytes)
+{
+    m_freeSlots.acquire();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_chunks.enqueue(bytes);
+    }
+    m_usedSlots.release();
+}
+
+void FileSaver::finish()
+{
+    // A used slot without a chunk behind it marks the end of the data
+    m_usedSlots.release();
+}
+
+bool FileSaver::takeChunk(QByteArray *chunk, bool *done)
+{
+    // Poll so a cancel request is noticed even when the GUI stops producing
+    while (!m_usedSlots.tryAcquire(1, 50)) {
+        if (isInterruptionRequested())
+            return false;
+    }
+    if (isInterruptionRequested())
+        return false;
+
+    QMutexLocker locker(&m_mutex);
+    *done = m_chunks.isEmpty();
+    if (!*done) {
+        *chunk = m_chunks.dequeue();
+        m_freeSlots.release();
+    }
+    return true;
+}
+
+void FileSaver::fail(const QString &errorString)
+{
+    m_errorString = errorString;
+    emit saveFailed(errorString);
+}
+
+void FileSaver::run()
+{
+    // Replace what a symlink points to rather than the link itself
+    QString target = m_fileName;
+    QFileInfo info(target);
+    if (info.isSymLink())
+        target = info.symLinkTarget();
+    info.setFile(target);
+
+    // Same directory as the target so the final rename never crosses volumes
+    QTemporaryFile file(info.absolutePath() + QLatin1String("/.") + info.fileName() + QLatin1String(".XXXXXX"));
+    if (!file.open()) {
+        fail(file.errorString());
+        return;
+    }
+
+    for (;;) {
+        QByteArray chunk;
+        bool done = false;
+        if (!takeChunk(&chunk, &done)) {
+            m_cancelled = true;
+            emit saveCancelled();
+            return;
+        }
+        if (done)
+            break;
+
+        if (file.write(chunk) != chunk.size()) {
+            fail(file.errorString());
+            return;
+        }
+    }
+
+    if (!file.flush()) {
+        fail(file.errorString());
+        return;
+    }
+    if (m_syncToDisk && !syncToDisk(file)) {
+        fail(tr("Cannot flush %1 to disk").arg(QDir::toNativeSeparators(file.fileName())));
+        return;
+    }
+
+    // Temporary files are private to the owner; keep the original's permissions
+    if (info.exists()) {
+        file.setPermissions(QFile::permissions(target));
+    } else {
+        file.setPermissions(QFile::ReadOwner | QFile::WriteOwner | QFile::ReadUser | QFile::WriteUser
+                            | QFile::ReadGroup | QFile::ReadOther);
+    }
+    file.close();
+
+    QString errorString;
+    if (!replaceFile(file.fileName(), target, &errorString)) {
+        fail(errorString);
+        return;
+    }
+
+    file.setAutoRemove(false);
+    m_succeeded = true;
+    emit saveFinished();
+}
@@ -0,0 +1,66 @@
+#ifndef FILESAVER_H
+#define FILESAVER_H
+
+#include <QThread>
+#include <QString>
+#include <QByteArray>
+#include <QQueue>
+#include <QMutex>
+#include <QSemaphore>
+
+// Writes a file on a worker thread from chunks produced by the GUI thread.
+// The data goes to a temporary file next to the target which is flushed to
+// disk and then renamed over the original, so the target is either the old
+// or the new contents but never a truncated mix. Only a few chunks are in
+// flight at once, so saving never holds a second copy of the document.
+class FileSaver : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit FileSaver(QObject *parent = nullptr);
+    ~FileSaver();
+
+    void save(const QString &fileName);
+    void cancel();
+    void setSyncToDisk(bool sync) { m_syncToDisk = sync; }
+
+    // Producer side, GUI thread only. write() must only be called while
+    // canWrite() is true; finish() marks the end of the data.
+    bool canWrite() const { return m_freeSlots.available() > 0; }
+    void write(const QByteArray &bytes);
+    void finish();
+
+    // Valid once the thread has finished
+    bool succeeded() const { return m_succeeded; }
+    bool wasCancelled() const { return m_cancelled; }
+    QString errorString() const { return m_errorString; }
+    QString fileName() const { return m_fileName; }
+
+signals:
+    void saveFinished();
+    void saveFailed(const QString &errorString);
+    void saveCancelled();
+
+protected:
+    void run() override;
+
+private:
+    QString m_fileName;
+    QString m_errorString;
+    bool m_syncToDisk;
+    bool m_succeeded;
+    bool m_cancelled;
+
+    QMutex m_mutex;
+    QQueue<QByteArray> m_chunks;
+    QSemaphore m_freeSlots;
+    QSemaphore m_usedSlots;
+
+    bool takeChunk(QByteArray *chunk, bool *done);
+    void fail(const QString &errorString);
+
+    static const int MaxChunksInFlight = 4;
+};
+
+#endif // FILESAVER_H
@@ -0,0 +1,79 @@
+#include "filewatcher.h"
+#include <QFileSystemWatcher>
+#include <QFileInfo>
+#include <QCoreApplication>
+
+FileWatcher &FileWatcher::instance()
+{
+    // Owned by the application so the watcher goes away before the event loop does
+    static FileWatcher *watcher = new FileWatcher(QCoreApplication::instance());
+    return *watcher;
+}
+
+FileWatcher::FileWatcher(QObject *parent) : QObject(parent)
+{
+    m_watcher = new QFileSystemWatcher(this);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &FileWatcher::pathChanged);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &FileWatcher::directoryChanged);
+}
+
+FileWatcher::~FileWatcher()
+{
+}
+
+void FileWatcher::watch(const QString &fileName)
+{
+    if (fileName.isEmpty())
+        return;
+
+    if (m_files[fileName]++ == 0)
+        m_watcher->addPath(fileName);
+
+    // The directory tells us when a rotated or replaced file comes back
+    QString directory = QFileInfo(fileName).absolutePath();
+    if (m_directories[directory]++ == 0)
+        m_watcher->addPath(directory);
+}
+
+void FileWatcher::unwatch(const QString &fileName)
+{
+    auto file = m_files.find(fileName);
+    if (file == m_files.end())
+        return;
+
+    if (--file.value() == 0) {
+        m_files.erase(file);
+        m_watcher->removePath(fileName);
+    }
+
+    QString directory = QFileInfo(fileName).absolutePath();
+    auto dir = m_directories.find(directory);
+    if (dir != m_directories.end() && --dir.value() == 0) {
+        m_directories.erase(dir);
+        m_watcher->removePath(directory);
+    }
+}
+
+void FileWatcher::pathChanged(const QString &path)
+{
+    // Watches on deleted or renamed files are dropped by the watcher;
+    // the file is added back once it exists again
+    if (!m_watcher->files().contains(path) && QFileInfo::exists(path))
+        m_watcher->addPath(path);
+
+    emit fileChanged(path);
+}
+
+void FileWatcher::directoryChanged(const QString &path)
+{
+    const QStringList watched = m_watcher->files();
+    for (auto it = m_files.constBegin(); it != m_files.constEnd(); ++it) {
+        if (watched.contains(it.key()) || QFileInfo(it.key()).absolutePath() != path)
+            continue;
+
+        if (QFileInfo::exists(it.key())) {
+            m_watcher->addPath(it.key());
+            emit fileChanged(it.key());
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+
+class QFileSystemWatcher;
+
+// One file system watcher shared by every tab, so the whole application
+// uses a single inotify instance (or the platform equivalent). Paths are
+// reference counted, and a file that is deleted or renamed away is picked
+// up again when something recreates it, which is what log rotation does.
+class FileWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    static FileWatcher &instance();
+
+    void watch(const QString &fileName);
+    void unwatch(const QString &fileName);
+
+signals:
+    void fileChanged(const QString &fileName);
+
+private slots:
+    void pathChanged(const QString &path);
+    void directoryChanged(const QString &path);
+
+private:
+    explicit FileWatcher(QObject *parent);
+    ~FileWatcher();
+
+    QFileSystemWatcher *m_watcher;
+    QHash<QString, int> m_files;
+    QHash<QString, int> m_directories;
+
+    Q_DISABLE_COPY(FileWatcher)
+};
+
+#endif // FILEWATCHER_H
@@ -94,7 +94,8 @@ void FindReplaceDialog::findNext()
 
 void FindReplaceDialog::replace()
 {
-    if (!editor)
+    // A document that is being saved is read-only until the save completes
+    if (!editor || editor->isReadOnly())
         return;
 
     QTextCursor cursor = editor->textCursor();
@@ -124,7 +125,7 @@ void FindReplaceDialog::replace()
 
 void FindReplaceDialog::replaceAll()
 {
-    if (!editor || findLineEdit->text().isEmpty())
+    if (!editor || editor->isReadOnly() || findLineEdit->text().isEmpty())
         return;
     
     QTextCursor originalCursor = editor->textCursor();
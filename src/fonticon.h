@@ -27,8 +27,18 @@ public:
         FA_REFRESH = 0xf021  // For reset
     };
     
+    // Registers the bundled FontAwesome font the first time it is needed,
+    // which is either a missing SVG icon or the deferred startup work
+    static bool loadFont()
+    {
+        static const int fontId = QFontDatabase::addApplicationFont(":/fonts/fontawesome-webfont.ttf");
+        return fontId != -1;
+    }
+    
     static QIcon icon(Icon iconCode, const QColor &color = QColor(50, 50, 50), int size = 16)
     {
+        loadFont();
+        
         // Try to get FontAwesome font
         QFont font("FontAwesome");
         if (!font.exactMatch()) {
@@ -0,0 +1,371 @@
+#include "hexview.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QFileInfo>
+#include <QScrollBar>
+#include <QFontMetrics>
+#include <algorithm>
+#include <functional>
+#include <climits>
+
+namespace {
+
+// Cells between the offset, hex and ASCII columns, and around the text
+const int ColumnGap = 2;
+const int Margin = 4;
+
+}
+
+HexView::HexView(QWidget *parent)
+    : QAbstractScrollArea(parent), m_cursor(0), m_matchStart(-1), m_matchLength(0),
+      m_darkTheme(false), m_offsetDigits(8), m_charWidth(1), m_rowHeight(1)
+{
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setCursor(Qt::IBeamCursor);
+    updateLayout();
+}
+
+HexView::~HexView()
+{
+    m_file.close();
+}
+
+bool HexView::open(const QString &fileName)
+{
+    // An empty file has nothing to map and is shown as an empty view
+    if (!m_file.open(fileName)) {
+        QFileInfo info(fileName);
+        if (!info.isReadable() || info.size() != 0) {
+            m_errorString = m_file.errorString();
+            return false;
+        }
+    }
+
+    m_cursor = 0;
+    m_matchStart = -1;
+    m_matchLength = 0;
+
+    // Wide enough for the last offset, but never narrower than 32 bits
+    m_offsetDigits = qMax(8, QString::number(m_file.size() - 1, 16).size());
+    updateLayout();
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+    viewport()->update();
+    return true;
+}
+
+void HexView::close()
+{
+    m_file.close();
+    updateLayout();
+    viewport()->update();
+}
+
+void HexView::setDarkTheme(bool dark)
+{
+    m_darkTheme = dark;
+    viewport()->update();
+}
+
+qint64 HexView::rowCount() const
+{
+    return (m_file.size() + BytesPerRow - 1) / BytesPerRow;
+}
+
+qint64 HexView::rowsPerStep() const
+{
+    // Scrollbars count in ints, which runs out at 32 GB of rows
+    const qint64 maxSteps = INT_MAX / 2;
+    return rowCount() / maxSteps + 1;
+}
+
+qint64 HexView::topRow() const
+{
+    return qMin(static_cast<qint64>(verticalScrollBar()->value()) * rowsPerStep(), qMax<qint64>(0, rowCount() - 1));
+}
+
+int HexView::visibleRows() const
+{
+    return qMax(1, viewport()->height() / m_rowHeight);
+}
+
+int HexView::hexColumn(int byte) const
+{
+    // An extra space splits the row into two groups of eight
+    return m_offsetDigits + ColumnGap + byte * 3 + (byte >= BytesPerRow / 2 ? 1 : 0);
+}
+
+int HexView::asciiColumn(int byte) const
+{
+    return hexColumn(BytesPerRow - 1) + 2 + ColumnGap + byte;
+}
+
+void HexView::updateLayout()
+{
+    QFontMetrics metrics(font());
+    m_charWidth = qMax(1, metrics.horizontalAdvance(QLatin1Char('0')));
+    m_rowHeight = qMax(1, metrics.height());
+
+    const qint64 step = rowsPerStep();
+    qint64 lastTop = qMax<qint64>(0, rowCount() - visibleRows());
+    verticalScrollBar()->setRange(0, static_cast<int>((lastTop + step - 1) / step));
+    verticalScrollBar()->setPageStep(qMax<qint64>(1, visibleRows() / step));
+    verticalScrollBar()->setSingleStep(1);
+
+    int width = 2 * Margin + asciiColumn(BytesPerRow) * m_charWidth;
+    horizontalScrollBar()->setRange(0, qMax(0, width - viewport()->width()));
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setSingleStep(m_charWidth);
+}
+
+void HexView::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(viewport());
+    const QColor background = m_darkTheme ? QColor(30, 30, 30) : QColor(255, 255, 255);
+    const QColor text = m_darkTheme ? QColor(220, 220, 220) : QColor(0, 0, 0);
+    const QColor dimmed = m_darkTheme ? QColor(133, 133, 133) : QColor(128, 128, 128);
+    const QColor cursor = m_darkTheme ? QColor(38, 79, 120) : QColor(173, 214, 255);
+    const QColor match = m_darkTheme ? QColor(98, 81, 26) : QColor(255, 230, 140);
+    painter.fillRect(event->rect(), background);
+    if (!m_file.isOpen())
+        return;
+
+    static const char digits[] = "0123456789ABCDEF";
+    const char *data = m_file.data();
+    const qint64 size = m_file.size();
+    const int left = Margin - horizontalScrollBar()->value();
+    const int ascent = QFontMetrics(font()).ascent();
+
+    // Only the rows in the viewport are formatted
+    qint64 row = topRow();
+    const int rows = visibleRows() + 1;
+    QString hex(hexColumn(BytesPerRow - 1) + 2 - hexColumn(0), QLatin1Char(' '));
+    QString ascii(BytesPerRow, QLatin1Char(' '));
+    for (int i = 0; i < rows && row * BytesPerRow < size; ++i, ++row) {
+        const qint64 offset = row * BytesPerRow;
+        const int count = static_cast<int>(qMin<qint64>(BytesPerRow, size - offset));
+        const int y = i * m_rowHeight;
+
+        hex.fill(QLatin1Char(' '));
+        ascii.fill(QLatin1Char(' '));
+        for (int byte = 0; byte < count; ++byte) {
+            const qint64 position = offset + byte;
+            const uchar value = static_cast<uchar>(data[position]);
+            const int column = hexColumn(byte) - hexColumn(0);
+            hex[column] = QLatin1Char(digits[value >> 4]);
+            hex[column + 1] = QLatin1Char(digits[value & 0xf]);
+            ascii[byte] = value >= 0x20 && value < 0x7f ? QLatin1Char(static_cast<char>(value)) : QLatin1Char('.');
+
+            bool inMatch = position >= m_matchStart && position < m_matchStart + m_matchLength;
+            if (position == m_cursor || inMatch) {
+                QColor fill = position == m_cursor ? cursor : match;
+                painter.fillRect(left + hexColumn(byte) * m_charWidth, y, 2 * m_charWidth, m_rowHeight, fill);
+                painter.fillRect(left + asciiColumn(byte) * m_charWidth, y, m_charWidth, m_rowHeight, fill);
+            }
+        }
+
+        painter.setPen(dimmed);
+        painter.drawText(left, y + ascent,
+                         QString::number(offset, 16).toUpper().rightJustified(m_offsetDigits, QLatin1Char('0')));
+        painter.setPen(text);
+        painter.drawText(left + hexColumn(0) * m_charWidth, y + ascent, hex);
+        painter.drawText(left + asciiColumn(0) * m_charWidth, y + ascent, ascii);
+    }
+}
+
+void HexView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateLayout();
+}
+
+void HexView::changeEvent(QEvent *event)
+{
+    QAbstractScrollArea::changeEvent(event);
+    if (event->type() == QEvent::FontChange) {
+        updateLayout();
+        viewport()->update();
+    }
+}
+
+void HexView::scrollContentsBy(int dx, int dy)
+{
+    Q_UNUSED(dx);
+    Q_UNUSED(dy);
+    viewport()->update();
+}
+
+void HexView::keyPressEvent(QKeyEvent *event)
+{
+    const qint64 page = static_cast<qint64>(visibleRows()) * BytesPerRow;
+    const qint64 rowStart = m_cursor - m_cursor % BytesPerRow;
+    const bool control = event->modifiers() & Qt::ControlModifier;
+
+    switch (event->key()) {
+    case Qt::Key_Left:
+        setCursorOffset(m_cursor - 1);
+        break;
+    case Qt::Key_Right:
+        setCursorOffset(m_cursor + 1);
+        break;
+    case Qt::Key_Up:
+        setCursorOffset(m_cursor - BytesPerRow);
+        break;
+    case Qt::Key_Down:
+        setCursorOffset(m_cursor + BytesPerRow);
+        break;
+    case Qt::Key_PageUp:
+        setCursorOffset(m_cursor - page);
+        break;
+    case Qt::Key_PageDown:
+        setCursorOffset(m_cursor + page);
+        break;
+    case Qt::Key_Home:
+        setCursorOffset(control ? 0 : rowStart);
+        break;
+    case Qt::Key_End:
+        setCursorOffset(control ? m_file.size() - 1 : rowStart + BytesPerRow - 1);
+        break;
+    default:
+        QAbstractScrollArea::keyPressEvent(event);
+    }
+}
+
+void HexView::wheelEvent(QWheelEvent *event)
+{
+    if (event->modifiers() & Qt::ControlModifier) {
+        if (event->angleDelta().y() != 0)
+            emit zoomRequested(event->angleDelta().y() > 0 ? 1 : -1);
+        event->accept();
+        return;
+    }
+    QAbstractScrollArea::wheelEvent(event);
+}
+
+void HexView::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton || !m_file.isOpen()) {
+        QAbstractScrollArea::mousePressEvent(event);
+        return;
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    const QPoint point = event->position().toPoint();
+#else
+    const QPoint point = event->pos();
+#endif
+    const int cell = (point.x() - Margin + horizontalScrollBar()->value()) / m_charWidth;
+    const qint64 row = topRow() + point.y() / m_rowHeight;
+
+    // Clicks land on the byte under either the hex or the ASCII column
+    int byte = -1;
+    if (cell >= asciiColumn(0)) {
+        byte = cell - asciiColumn(0);
+    } else if (cell >= hexColumn(0)) {
+        byte = cell >= hexColumn(BytesPerRow / 2) ? BytesPerRow / 2 + (cell - hexColumn(BytesPerRow / 2)) / 3
+                                                  : (cell - hexColumn(0)) / 3;
+    }
+    if (byte < 0)
+        byte = 0;
+    setCursorOffset(row * BytesPerRow + qMin(byte, BytesPerRow - 1));
+}
+
+void HexView::setCursorOffset(qint64 offset)
+{
+    m_cursor = qBound<qint64>(0, offset, qMax<qint64>(0, m_file.size() - 1));
+    ensureCursorVisible();
+    viewport()->update();
+    emit cursorOffsetChanged(m_cursor);
+}
+
+void HexView::ensureCursorVisible()
+{
+    const qint64 row = m_cursor / BytesPerRow;
+    const qint64 top = topRow();
+    const qint64 step = rowsPerStep();
+    const int rows = visibleRows();
+    if (row < top)
+        verticalScrollBar()->setValue(static_cast<int>(row / step));
+    else if (row >= top + rows)
+        verticalScrollBar()->setValue(static_cast<int>((row - rows + step) / step));
+}
+
+void HexView::goToOffset(qint64 offset)
+{
+    // Jumps put the target row in the middle of the screen
+    offset = qBound<qint64>(0, offset, qMax<qint64>(0, m_file.size() - 1));
+    const qint64 row = offset / BytesPerRow;
+    verticalScrollBar()->setValue(static_cast<int>(qMax<qint64>(0, row - visibleRows() / 2) / rowsPerStep()));
+    setCursorOffset(offset);
+}
+
+qint64 HexView::search(const QByteArray &pattern, qint64 from, qint64 to, bool backward) const
+{
+    if (to - from < pattern.size())
+        return -1;
+
+    // Runs straight over the mapping; only the pages scanned are touched
+    const char *begin = m_file.data() + from;
+    const char *end = m_file.data() + to;
+    const char *match;
+    if (backward) {
+        match = std::find_end(begin, end, pattern.constBegin(), pattern.constEnd());
+    } else {
+        std::boyer_moore_horspool_searcher<const char *> searcher(pattern.constBegin(), pattern.constEnd());
+        match = std::search(begin, end, searcher);
+    }
+    return match == end ? -1 : match - m_file.data();
+}
+
+bool HexView::findNext(const QByteArray &pattern, bool backward)
+{
+    if (pattern.isEmpty() || !m_file.isOpen())
+        return false;
+
+    const qint64 size = m_file.size();
+    const qint64 length = pattern.size();
+    qint64 found;
+    if (!backward) {
+        // Step past a match that is already selected
+        qint64 from = m_matchLength > 0 && m_matchStart == m_cursor ? m_cursor + 1 : m_cursor;
+        found = search(pattern, from, size, false);
+        if (found < 0)
+            found = search(pattern, 0, qMin(size, from + length - 1), false);
+    } else {
+        found = search(pattern, 0, qMin(size, m_cursor + length - 1), true);
+        if (found < 0)
+            found = search(pattern, m_cursor, size, true);
+    }
+    if (found < 0)
+        return false;
+
+    m_matchStart = found;
+    m_matchLength = length;
+    goToOffset(found);
+    return true;
+}
+
+bool HexView::parsePattern(const QString &text, QByteArray *pattern)
+{
+    QString trimmed = text.trimmed();
+    if (trimmed.size() >= 2 && trimmed.startsWith(QLatin1Char('"')) && trimmed.endsWith(QLatin1Char('"'))) {
+        *pattern = trimmed.mid(1, trimmed.size() - 2).toUtf8();
+        return !pattern->isEmpty();
+    }
+
+    QString digits = trimmed;
+    digits.remove(QLatin1Char(' '));
+    if (digits.startsWith(QLatin1String("0x"), Qt::CaseInsensitive))
+        digits.remove(0, 2);
+    if (digits.isEmpty() || digits.size() % 2 != 0)
+        return false;
+    for (QChar c : digits) {
+        if (!c.isDigit() && (c.toLower() < QLatin1Char('a') || c.toLower() > QLatin1Char('f')))
+            return false;
+    }
+    *pattern = QByteArray::fromHex(digits.toLatin1());
+    return true;
+}
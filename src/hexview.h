@@ -0,0 +1,79 @@
+#ifndef HEXVIEW_H
+#define HEXVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QByteArray>
+#include <QString>
+#include "mappedfile.h"
+
+// Read-only offset/hex/ASCII view of a binary file. The file is memory
+// mapped and only the rows inside the viewport are ever formatted, so
+// opening is instant and memory use does not grow with the file size.
+class HexView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    explicit HexView(QWidget *parent = nullptr);
+    ~HexView();
+
+    bool open(const QString &fileName);
+    void close();
+    QString errorString() const { return m_errorString; }
+    qint64 fileSize() const { return m_file.size(); }
+
+    qint64 cursorOffset() const { return m_cursor; }
+    void goToOffset(qint64 offset);
+
+    // Searches from just past the cursor, wrapping around at the end of
+    // the file, and selects the match
+    bool findNext(const QByteArray &pattern, bool backward = false);
+
+    // Accepts hex byte pairs ("7F 45 4C 46") or a quoted string ("ELF")
+    static bool parsePattern(const QString &text, QByteArray *pattern);
+
+    void setDarkTheme(bool dark);
+
+signals:
+    void cursorOffsetChanged(qint64 offset);
+
+    // Ctrl+wheel; the owner keeps the zoom level and sets the font
+    void zoomRequested(int steps);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+
+private:
+    MappedFile m_file;
+    QString m_errorString;
+    qint64 m_cursor;
+    qint64 m_matchStart;
+    qint64 m_matchLength;
+    bool m_darkTheme;
+
+    // Layout in character cells, recomputed when the font changes
+    int m_offsetDigits;
+    int m_charWidth;
+    int m_rowHeight;
+
+    qint64 rowCount() const;
+    qint64 rowsPerStep() const;
+    qint64 topRow() const;
+    int visibleRows() const;
+    int hexColumn(int byte) const;
+    int asciiColumn(int byte) const;
+    void updateLayout();
+    void setCursorOffset(qint64 offset);
+    void ensureCursorVisible();
+    qint64 search(const QByteArray &pattern, qint64 from, qint64 to, bool backward) const;
+
+    static const int BytesPerRow = 16;
+};
+
+#endif // HEXVIEW_H
@@ -0,0 +1,58 @@
+#ifndef CHARCLASS_H
+#define CHARCLASS_H
+
+#include <array>
+#include <cstdint>
+
+// Character classes of the ASCII range, computed at compile time so the
+// lexer tests a character with one table load. Word characters are the
+// ones \b in the language patterns treats as such; everything outside
+// ASCII belongs to no class.
+namespace CharClass {
+
+enum : std::uint8_t {
+    Word = 0x01,
+    Digit = 0x02,
+    Space = 0x04,
+    Operator = 0x08,
+    Upper = 0x10
+};
+
+constexpr std::array<std::uint8_t, 128> makeTable()
+{
+    std::array<std::uint8_t, 128> table{};
+    for (int c = 0; c < 128; ++c) {
+        std::uint8_t classes = 0;
+        if ((c >= 'a' && c <= 'z') || c == '_')
+            classes |= Word;
+        if (c >= 'A' && c <= 'Z')
+            classes |= Word | Upper;
+        if (c >= '0' && c <= '9')
+            classes |= Word | Digit;
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v')
+            classes |= Space;
+        if (c > ' ' && c < 127 && !(classes & Word))
+            classes |= Operator;
+        table[c] = classes;
+    }
+    return table;
+}
+
+constexpr std::array<std::uint8_t, 128> table = makeTable();
+
+constexpr bool is(std::uint32_t c, std::uint8_t classes)
+{
+    return c < 128 && (table[c] & classes);
+}
+
+constexpr bool isWord(std::uint32_t c) { return is(c, Word); }
+
+// ASCII-only case folding, as used for case-insensitive keywords
+constexpr std::uint32_t fold(std::uint32_t c)
+{
+    return is(c, Upper) ? c + ('a' - 'A') : c;
+}
+
+} // namespace CharClass
+
+#endif // CHARCLASS_H
@@ -1,4 +1,5 @@
 #include "highlighterfactory.h"
+#include <QSettings>
 
 HighlighterFactory& HighlighterFactory::instance()
 {
@@ -64,13 +65,36 @@ SyntaxHighlighter* HighlighterFactory::createHighlighter(const QString &language
 {
     // If language exists in our map
     if (m_languages.contains(language)) {
-        return new SyntaxHighlighter(*m_languages[language], document);
+        SyntaxHighlighter *highlighter = new SyntaxHighlighter(ruleSetForLanguage(language), document);
+        highlighter->setEngine(engineForLanguage(language));
+        return highlighter;
     }
     
     // Otherwise return a plain text highlighter
     return new SyntaxHighlighter(document);
 }
 
+QSharedPointer<const RuleSet> HighlighterFactory::ruleSetForLanguage(const QString &language)
+{
+    // Compiling and optimizing the regexes and making the dark palette is
+    // done once; later tabs of the language only take a reference
+    QSharedPointer<const RuleSet> &ruleSet = m_ruleSets[language];
+    if (!ruleSet)
+        ruleSet.reset(new RuleSet(*m_languages.value(language)));
+    return ruleSet;
+}
+
+Lexer::Engine HighlighterFactory::engineForLanguage(const QString &language) const
+{
+    // "highlightingEngine/<language>" overrides "highlightingEngine"; both
+    // take "scanner" (the default) or "overlay", so the two lexers can be
+    // compared language by language
+    QSettings settings("NotepadX", "Editor");
+    QString engine = settings.value("highlightingEngine", "scanner").toString();
+    engine = settings.value("highlightingEngine/" + language, engine).toString();
+    return engine == "overlay" ? Lexer::OverlayEngine : Lexer::ScannerEngine;
+}
+
 QString HighlighterFactory::languageForExtension(const QString &extension)
 {
     if (m_extensionMap.contains(extension)) {
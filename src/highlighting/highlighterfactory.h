@@ -46,9 +46,18 @@ private:
     
     // Private helper to find language by extension
     QString languageForExtension(const QString &extension);
+
+    // Lexer engine chosen in the settings for a language
+    Lexer::Engine engineForLanguage(const QString &language) const;
+
+    // The compiled rules of a language, built the first time it is used
+    QSharedPointer<const RuleSet> ruleSetForLanguage(const QString &language);
     
     // Store available languages
     QMap<QString, LanguageData*> m_languages;
+
+    // Shared by every highlighter of a language
+    QMap<QString, QSharedPointer<const RuleSet>> m_ruleSets;
     
     // Map of extensions to language names
     QMap<QString, QString> m_extensionMap;
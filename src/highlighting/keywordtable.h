@@ -0,0 +1,197 @@
+#ifndef KEYWORDTABLE_H
+#define KEYWORDTABLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "charclass.h"
+
+// The keywords of a language, in a perfect hash table built by the
+// compiler (hash and displace): words are first spread over buckets, and
+// every bucket gets a seed that puts its words into free slots. A lookup
+// is two short hashes and at most one compare, however many words there
+// are, and nothing is allocated or built at run time.
+//
+// A language declares its words as an array and builds the table from it:
+//
+//     static constexpr std::string_view keywords[] = { "if", "else" };
+//     static constexpr auto keywordTable = makeKeywordTable(keywords);
+//
+// Words are ASCII identifiers; a case-insensitive table folds ASCII letters.
+// KeywordTable is a cheap view of such a table and is passed by value.
+class KeywordTable
+{
+public:
+    constexpr KeywordTable()
+        : m_slots(nullptr), m_seeds(nullptr), m_mask(0), m_bucketMask(0), m_caseSensitive(true)
+    {
+    }
+
+    constexpr KeywordTable(const std::string_view *slots, const std::uint32_t *seeds,
+                           std::uint32_t mask, std::uint32_t bucketMask, bool caseSensitive)
+        : m_slots(slots), m_seeds(seeds), m_mask(mask), m_bucketMask(bucketMask), m_caseSensitive(caseSensitive)
+    {
+    }
+
+    constexpr bool isNull() const { return m_slots == nullptr; }
+
+    // Char is any type holding UTF-16 code units
+    template <typename Char>
+    constexpr bool contains(const Char *word, std::size_t length) const
+    {
+        if (!m_slots)
+            return false;
+        std::uint32_t seed = m_seeds[hash(word, length, 0, m_caseSensitive) & m_bucketMask];
+        return equal(m_slots[hash(word, length, seed, m_caseSensitive) & m_mask], word, length, m_caseSensitive);
+    }
+
+    template <typename Char>
+    static constexpr std::uint32_t hash(const Char *word, std::size_t length, std::uint32_t seed, bool caseSensitive)
+    {
+        // FNV-1a, seeded, with a final mix so the low bits used as the
+        // slot depend on every character
+        std::uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+        for (std::size_t i = 0; i < length; ++i) {
+            std::uint32_t c = static_cast<std::uint32_t>(word[i]);
+            h ^= caseSensitive ? c : CharClass::fold(c);
+            h *= 16777619u;
+        }
+        h ^= h >> 15;
+        h *= 0x2c1b3c6du;
+        h ^= h >> 12;
+        return h;
+    }
+
+    template <typename Char>
+    static constexpr bool equal(std::string_view key, const Char *word, std::size_t length, bool caseSensitive)
+    {
+        if (key.size() != length)
+            return false;
+        for (std::size_t i = 0; i < length; ++i) {
+            std::uint32_t a = static_cast<std::uint8_t>(key[i]);
+            std::uint32_t b = static_cast<std::uint32_t>(word[i]);
+            if (caseSensitive ? a != b : CharClass::fold(a) != CharClass::fold(b))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    const std::string_view *m_slots;
+    const std::uint32_t *m_seeds;
+    std::uint32_t m_mask;
+    std::uint32_t m_bucketMask;
+    bool m_caseSensitive;
+};
+
+enum KeywordCase {
+    CaseSensitive,
+    CaseInsensitive
+};
+
+// Not constexpr on purpose: reaching it while building a table makes the
+// build fail to compile instead of producing a table with missing words
+inline void keywordTableSeedNotFound() {}
+
+// Storage for the table of N words; only makeKeywordTable() creates one
+template <std::size_t N>
+class StaticKeywordTable
+{
+public:
+    // Twice as many slots as words, four slots per bucket
+    static constexpr std::size_t Size = [] {
+        std::size_t size = 8;
+        while (size < 2 * N)
+            size *= 2;
+        return size;
+    }();
+    static constexpr std::size_t Buckets = Size / 4;
+
+    constexpr StaticKeywordTable(const std::string_view (&words)[N], KeywordCase keywordCase)
+        : m_slots{}, m_seeds{}, m_caseSensitive(keywordCase == CaseSensitive)
+    {
+        // Spread the words over the buckets, dropping repeated ones
+        std::array<std::uint32_t, N> hashes{};
+        std::array<std::size_t, N> bucketOf{};
+        std::array<std::size_t, Buckets> bucketSize{};
+        std::size_t largest = 0;
+        for (std::size_t i = 0; i < N; ++i) {
+            hashes[i] = KeywordTable::hash(words[i].data(), words[i].size(), 0, m_caseSensitive);
+            bucketOf[i] = Buckets;
+            bool repeated = false;
+            for (std::size_t j = 0; j < i && !repeated; ++j) {
+                repeated = hashes[j] == hashes[i]
+                        && KeywordTable::equal(words[j], words[i].data(), words[i].size(), m_caseSensitive);
+            }
+            if (repeated)
+                continue;
+            bucketOf[i] = hashes[i] & (Buckets - 1);
+            if (++bucketSize[bucketOf[i]] > largest)
+                largest = bucketSize[bucketOf[i]];
+        }
+
+        // The biggest buckets are placed first, while the table is emptiest
+        for (std::size_t size = largest; size > 0; --size) {
+            for (std::size_t bucket = 0; bucket < Buckets; ++bucket) {
+                if (bucketSize[bucket] != size)
+                    continue;
+                std::array<std::size_t, N> members{};
+                std::size_t count = 0;
+                for (std::size_t i = 0; i < N; ++i) {
+                    if (bucketOf[i] == bucket)
+                        members[count++] = i;
+                }
+                if (!place(words, members, count, bucket))
+                    keywordTableSeedNotFound();
+            }
+        }
+    }
+
+    constexpr KeywordTable table() const
+    {
+        return KeywordTable(m_slots.data(), m_seeds.data(), Size - 1, Buckets - 1, m_caseSensitive);
+    }
+
+    constexpr operator KeywordTable() const { return table(); }
+
+private:
+    constexpr bool place(const std::string_view (&words)[N], const std::array<std::size_t, N> &members,
+                         std::size_t count, std::size_t bucket)
+    {
+        for (std::uint32_t seed = 1; seed <= MaxSeed; ++seed) {
+            std::array<std::size_t, N> slots{};
+            bool fits = true;
+            for (std::size_t i = 0; i < count && fits; ++i) {
+                const std::string_view &word = words[members[i]];
+                slots[i] = KeywordTable::hash(word.data(), word.size(), seed, m_caseSensitive) & (Size - 1);
+                fits = m_slots[slots[i]].empty();
+                for (std::size_t j = 0; j < i && fits; ++j)
+                    fits = slots[j] != slots[i];
+            }
+            if (!fits)
+                continue;
+
+            for (std::size_t i = 0; i < count; ++i)
+                m_slots[slots[i]] = words[members[i]];
+            m_seeds[bucket] = seed;
+            return true;
+        }
+        return false;
+    }
+
+    static constexpr std::uint32_t MaxSeed = 1024;
+
+    std::array<std::string_view, Size> m_slots;
+    std::array<std::uint32_t, Buckets> m_seeds;
+    bool m_caseSensitive;
+};
+
+template <std::size_t N>
+constexpr StaticKeywordTable<N> makeKeywordTable(const std::string_view (&words)[N],
+                                                 KeywordCase keywordCase = CaseSensitive)
+{
+    return StaticKeywordTable<N>(words, keywordCase);
+}
+
+#endif // KEYWORDTABLE_H
@@ -1,6 +1,6 @@
 #include "languagedata.h"
 
-LanguageData::LanguageData() : m_name("Plain Text")
+LanguageData::LanguageData() : m_name("Plain Text"), m_nestedComments(false)
 {
     // Base implementation for plain text (no highlighting)
     m_fileExtensions << "txt";
@@ -9,3 +9,26 @@ LanguageData::LanguageData() : m_name("Plain Text")
     m_commentStartExpression = QRegularExpression("(?!)"); // This is a valid pattern that never matches
     m_commentEndExpression = QRegularExpression("(?!)");   // Same here
 }
+
+QVector<BlockRegion> LanguageData::blockRegions() const
+{
+    QVector<BlockRegion> regions;
+    if (!m_commentStartExpression.pattern().isEmpty() && m_commentStartExpression.isValid()
+        && m_commentEndExpression.isValid()) {
+        BlockRegion comment;
+        comment.start = m_commentStartExpression;
+        comment.end = m_commentEndExpression;
+        comment.format = m_multiLineCommentFormat;
+        comment.nested = m_nestedComments;
+        regions.append(comment);
+    }
+    return regions + m_blockRegions;
+}
+
+void LanguageData::addKeywords(KeywordTable keywords, const QTextCharFormat &format)
+{
+    HighlightingRule rule;
+    rule.keywords = keywords;
+    rule.format = format;
+    m_highlightingRules.append(rule);
+}
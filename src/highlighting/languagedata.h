@@ -5,11 +5,35 @@
 #include <QString>
 #include <QTextCharFormat>
 #include <QRegularExpression>
+#include "keywordtable.h"
 
 struct HighlightingRule {
     QRegularExpression pattern;
     QTextCharFormat format;
     QTextCharFormat darkThemeFormat; // Add storage for dark theme format
+
+    // Set instead of a pattern for a list of keywords in format
+    KeywordTable keywords;
+};
+
+// A construct other than the multi-line comment that can run over several
+// blocks: a triple-quoted or raw string, a heredoc. The block state records
+// which one is open, how deep and with what delimiter.
+struct BlockRegion {
+    QRegularExpression start;
+    QRegularExpression end;
+    QTextCharFormat format;
+
+    // Set instead of end when the end depends on the start: %1 stands for
+    // what the start's "delimiter" group captured, as for raw strings
+    QString endPattern;
+
+    bool nested = false;            // starts inside count, like Rust comments
+    bool bodyOnNextLine = false;    // heredocs begin on the following line
+
+    // Set when a match of start only opens the region in some contexts of
+    // the line, as for heredocs, which must not be taken for shifts
+    bool (*startAllowed)(const QString &text, int start) = nullptr;
 };
 
 class LanguageData {
@@ -25,17 +49,25 @@ public:
     QRegularExpression commentEndExpression() const { return m_commentEndExpression; }
     QTextCharFormat multiLineCommentFormat() const { return m_multiLineCommentFormat; }
     QTextCharFormat multiLineCommentDarkFormat() const { return m_multiLineCommentDarkFormat; }
+
+    // The multi-line comment, if any, followed by the other regions
+    QVector<BlockRegion> blockRegions() const;
     
     // File extensions supported by this language
     QStringList fileExtensions() const { return m_fileExtensions; }
-    
+
 protected:
+    // Adds a rule for a keyword table built with makeKeywordTable()
+    void addKeywords(KeywordTable keywords, const QTextCharFormat &format);
+
     QString m_name;
     QVector<HighlightingRule> m_highlightingRules;
     QRegularExpression m_commentStartExpression;
     QRegularExpression m_commentEndExpression;
     QTextCharFormat m_multiLineCommentFormat;
     QTextCharFormat m_multiLineCommentDarkFormat; // Dark theme version
+    bool m_nestedComments;
+    QVector<BlockRegion> m_blockRegions;
     QStringList m_fileExtensions;
 };
 
@@ -28,29 +28,19 @@ CppLanguage::CppLanguage()
     m_multiLineCommentFormat.setForeground(Qt::darkGreen);
     
     // Define C++ keywords
-    const QStringList keywordPatterns = {
-        "\\bclass\\b", "\\bconst\\b", "\\benum\\b", "\\bexplicit\\b",
-        "\\bfriend\\b", "\\binline\\b", "\\bnamespace\\b", "\\boperator\\b",
-        "\\bprivate\\b", "\\bprotected\\b", "\\bpublic\\b", "\\bsignals\\b",
-        "\\bslots\\b", "\\bstatic\\b", "\\bstruct\\b", "\\btemplate\\b",
-        "\\btypedef\\b", "\\btypename\\b", "\\bunion\\b", "\\bvirtual\\b",
-        "\\bvolatile\\b", "\\bbool\\b", "\\bbreak\\b", "\\bcase\\b",
-        "\\bcatch\\b", "\\bchar\\b", "\\bcontinue\\b", "\\bdefault\\b",
-        "\\bdelete\\b", "\\bdo\\b", "\\bdouble\\b", "\\belse\\b",
-        "\\bfloat\\b", "\\bfor\\b", "\\bif\\b", "\\bint\\b",
-        "\\blong\\b", "\\bnew\\b", "\\breturn\\b", "\\bshort\\b",
-        "\\bsigned\\b", "\\bsizeof\\b", "\\bstatic_cast\\b", "\\bswitch\\b",
-        "\\bthis\\b", "\\bthrow\\b", "\\btry\\b", "\\bunsigned\\b",
-        "\\bvoid\\b", "\\bwhile\\b"
+    static constexpr std::string_view keywords[] = {
+        "class", "const", "enum", "explicit", "friend", "inline", "namespace",
+        "operator", "private", "protected", "public", "signals", "slots", "static",
+        "struct", "template", "typedef", "typename", "union", "virtual", "volatile",
+        "bool", "break", "case", "catch", "char", "continue", "default", "delete",
+        "do", "double", "else", "float", "for", "if", "int", "long", "new",
+        "return", "short", "signed", "sizeof", "static_cast", "switch", "this",
+        "throw", "try", "unsigned", "void", "while"
     };
+    static constexpr auto keywordTable = makeKeywordTable(keywords);
     
     // Create rules for each keyword
-    for (const QString &pattern : keywordPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = keywordFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(keywordTable, keywordFormat);
     
     // Class names (Qt classes starting with Q)
     HighlightingRule rule;
@@ -77,4 +67,11 @@ CppLanguage::CppLanguage()
     // Multi-line comment expressions
     m_commentStartExpression = QRegularExpression("/\\*");
     m_commentEndExpression = QRegularExpression("\\*/");
+    
+    // Raw string literals, closed by ) and the delimiter they opened with
+    BlockRegion rawString;
+    rawString.start = QRegularExpression("R\"(?<delimiter>[^()\\\\\\s\"]{0,16})\\(");
+    rawString.endPattern = "\\)%1\"";
+    rawString.format = quotationFormat;
+    m_blockRegions.append(rawString);
 }
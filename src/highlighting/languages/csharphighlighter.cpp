@@ -37,37 +37,26 @@ CSharpLanguage::CSharpLanguage()
     m_multiLineCommentFormat.setForeground(Qt::darkGreen);
     
     // Define C# keywords
-    const QStringList keywordPatterns = {
-        "\\babstract\\b", "\\bas\\b", "\\bbase\\b", "\\bbool\\b", "\\bbreak\\b", 
-        "\\bbyte\\b", "\\bcase\\b", "\\bcatch\\b", "\\bchar\\b", "\\bchecked\\b", 
-        "\\bclass\\b", "\\bconst\\b", "\\bcontinue\\b", "\\bdecimal\\b", "\\bdefault\\b", 
-        "\\bdelegate\\b", "\\bdo\\b", "\\bdouble\\b", "\\belse\\b", "\\benum\\b", 
-        "\\bevent\\b", "\\bexplicit\\b", "\\bextern\\b", "\\bfalse\\b", "\\bfinally\\b", 
-        "\\bfixed\\b", "\\bfloat\\b", "\\bfor\\b", "\\bforeach\\b", "\\bgoto\\b", 
-        "\\bif\\b", "\\bimplicit\\b", "\\bin\\b", "\\bint\\b", "\\binterface\\b", 
-        "\\binternal\\b", "\\bis\\b", "\\block\\b", "\\blong\\b", "\\bnamespace\\b", 
-        "\\bnew\\b", "\\bnull\\b", "\\bobject\\b", "\\boperator\\b", "\\bout\\b", 
-        "\\boverride\\b", "\\bparams\\b", "\\bprivate\\b", "\\bprotected\\b", "\\bpublic\\b", 
-        "\\breadonly\\b", "\\bref\\b", "\\breturn\\b", "\\bsbyte\\b", "\\bsealed\\b", 
-        "\\bshort\\b", "\\bsizeof\\b", "\\bstackalloc\\b", "\\bstatic\\b", "\\bstring\\b", 
-        "\\bstruct\\b", "\\bswitch\\b", "\\bthis\\b", "\\bthrow\\b", "\\btrue\\b", 
-        "\\btry\\b", "\\btypeof\\b", "\\buint\\b", "\\bulong\\b", "\\bunchecked\\b", 
-        "\\bunsafe\\b", "\\bushort\\b", "\\busing\\b", "\\bvirtual\\b", "\\bvoid\\b", 
-        "\\bvolatile\\b", "\\bwhile\\b", "\\badd\\b", "\\balias\\b", "\\bascending\\b", 
-        "\\basync\\b", "\\bawait\\b", "\\bdescending\\b", "\\bdynamic\\b", "\\bfrom\\b", 
-        "\\bget\\b", "\\bglobal\\b", "\\bgroup\\b", "\\binto\\b", "\\bjoin\\b", 
-        "\\blet\\b", "\\bnameof\\b", "\\borderby\\b", "\\bpartial\\b", "\\bremove\\b", 
-        "\\bselect\\b", "\\bset\\b", "\\bvalue\\b", "\\bvar\\b", "\\bwhen\\b", 
-        "\\bwhere\\b", "\\byield\\b"
+    static constexpr std::string_view keywords[] = {
+        "abstract", "as", "base", "bool", "break", "byte", "case", "catch", "char",
+        "checked", "class", "const", "continue", "decimal", "default", "delegate",
+        "do", "double", "else", "enum", "event", "explicit", "extern", "false",
+        "finally", "fixed", "float", "for", "foreach", "goto", "if", "implicit",
+        "in", "int", "interface", "internal", "is", "lock", "long", "namespace",
+        "new", "null", "object", "operator", "out", "override", "params", "private",
+        "protected", "public", "readonly", "ref", "return", "sbyte", "sealed",
+        "short", "sizeof", "stackalloc", "static", "string", "struct", "switch",
+        "this", "throw", "true", "try", "typeof", "uint", "ulong", "unchecked",
+        "unsafe", "ushort", "using", "virtual", "void", "volatile", "while", "add",
+        "alias", "ascending", "async", "await", "descending", "dynamic", "from",
+        "get", "global", "group", "into", "join", "let", "nameof", "orderby",
+        "partial", "remove", "select", "set", "value", "var", "when", "where",
+        "yield"
     };
+    static constexpr auto keywordTable = makeKeywordTable(keywords);
     
     // Create rules for each keyword
-    for (const QString &pattern : keywordPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = keywordFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(keywordTable, keywordFormat);
     
     // Type names (starting with capital letter)
     HighlightingRule rule;
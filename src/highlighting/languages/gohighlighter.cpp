@@ -33,54 +33,35 @@ GoLanguage::GoLanguage()
     m_multiLineCommentFormat.setForeground(Qt::darkGreen);
     
     // Define Go keywords
-    const QStringList keywordPatterns = {
-        "\\bbreak\\b", "\\bcase\\b", "\\bchan\\b", "\\bconst\\b", 
-        "\\bcontinue\\b", "\\bdefault\\b", "\\bdefer\\b", "\\belse\\b", 
-        "\\bfallthrough\\b", "\\bfor\\b", "\\bfunc\\b", "\\bgo\\b", 
-        "\\bgoto\\b", "\\bif\\b", "\\bimport\\b", "\\binterface\\b", 
-        "\\bmap\\b", "\\bpackage\\b", "\\brange\\b", "\\breturn\\b", 
-        "\\bselect\\b", "\\bstruct\\b", "\\bswitch\\b", "\\btype\\b", 
-        "\\bvar\\b"
+    static constexpr std::string_view keywords[] = {
+        "break", "case", "chan", "const", "continue", "default", "defer", "else",
+        "fallthrough", "for", "func", "go", "goto", "if", "import", "interface",
+        "map", "package", "range", "return", "select", "struct", "switch", "type",
+        "var"
     };
+    static constexpr auto keywordTable = makeKeywordTable(keywords);
     
     // Create rules for each keyword
-    for (const QString &pattern : keywordPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = keywordFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(keywordTable, keywordFormat);
     
     // Go built-in types
-    const QStringList typePatterns = {
-        "\\bbool\\b", "\\bbyte\\b", "\\bcomplex64\\b", "\\bcomplex128\\b", 
-        "\\berror\\b", "\\bfloat32\\b", "\\bfloat64\\b", "\\bint\\b", 
-        "\\bint8\\b", "\\bint16\\b", "\\bint32\\b", "\\bint64\\b", 
-        "\\brune\\b", "\\bstring\\b", "\\buint\\b", "\\buint8\\b", 
-        "\\buint16\\b", "\\buint32\\b", "\\buint64\\b", "\\buintptr\\b"
+    static constexpr std::string_view types[] = {
+        "bool", "byte", "complex64", "complex128", "error", "float32", "float64",
+        "int", "int8", "int16", "int32", "int64", "rune", "string", "uint", "uint8",
+        "uint16", "uint32", "uint64", "uintptr"
     };
+    static constexpr auto typeTable = makeKeywordTable(types);
     
-    for (const QString &pattern : typePatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = typeFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(typeTable, typeFormat);
     
     // Go built-in functions
-    const QStringList builtinPatterns = {
-        "\\bappend\\b", "\\bcap\\b", "\\bclose\\b", "\\bcomplex\\b", 
-        "\\bcopy\\b", "\\bdelete\\b", "\\bimag\\b", "\\blen\\b", 
-        "\\bmake\\b", "\\bnew\\b", "\\bpanic\\b", "\\bprint\\b", 
-        "\\bprintln\\b", "\\breal\\b", "\\brecover\\b"
+    static constexpr std::string_view builtins[] = {
+        "append", "cap", "close", "complex", "copy", "delete", "imag", "len",
+        "make", "new", "panic", "print", "println", "real", "recover"
     };
+    static constexpr auto builtinTable = makeKeywordTable(builtins);
     
-    for (const QString &pattern : builtinPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = builtinFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(builtinTable, builtinFormat);
     
     // Single-line comments
     HighlightingRule rule;
@@ -34,25 +34,24 @@ JavaLanguage::JavaLanguage()
     m_multiLineCommentFormat.setForeground(Qt::darkGreen);
     
     // Define Java keywords
+    static constexpr std::string_view keywords[] = {
+        "abstract", "assert", "boolean", "break", "byte", "case", "catch", "char",
+        "class", "const", "continue", "default", "do", "double", "else", "enum",
+        "extends", "final", "finally", "float", "for", "if", "goto", "implements",
+        "import", "instanceof", "int", "interface", "long", "native", "new",
+        "package", "private", "protected", "public", "return", "short", "static",
+        "strictfp", "super", "switch", "synchronized", "this", "throw", "throws",
+        "transient", "try", "void", "volatile", "while", "true", "false", "null",
+        "var", "yield", "record", "sealed", "permits", "module", "open", "requires",
+        "exports", "opens", "to", "uses", "provides", "with"
+    };
+    static constexpr auto keywordTable = makeKeywordTable(keywords);
     const QStringList keywordPatterns = {
-        "\\babstract\\b", "\\bassert\\b", "\\bboolean\\b", "\\bbreak\\b", 
-        "\\bbyte\\b", "\\bcase\\b", "\\bcatch\\b", "\\bchar\\b", "\\bclass\\b", 
-        "\\bconst\\b", "\\bcontinue\\b", "\\bdefault\\b", "\\bdo\\b", "\\bdouble\\b", 
-        "\\belse\\b", "\\benum\\b", "\\bextends\\b", "\\bfinal\\b", "\\bfinally\\b", 
-        "\\bfloat\\b", "\\bfor\\b", "\\bif\\b", "\\bgoto\\b", "\\bimplements\\b", 
-        "\\bimport\\b", "\\binstanceof\\b", "\\bint\\b", "\\binterface\\b", 
-        "\\blong\\b", "\\bnative\\b", "\\bnew\\b", "\\bpackage\\b", "\\bprivate\\b", 
-        "\\bprotected\\b", "\\bpublic\\b", "\\breturn\\b", "\\bshort\\b", "\\bstatic\\b", 
-        "\\bstrictfp\\b", "\\bsuper\\b", "\\bswitch\\b", "\\bsynchronized\\b", 
-        "\\bthis\\b", "\\bthrow\\b", "\\bthrows\\b", "\\btransient\\b", "\\btry\\b", 
-        "\\bvoid\\b", "\\bvolatile\\b", "\\bwhile\\b", "\\btrue\\b", "\\bfalse\\b", 
-        "\\bnull\\b", "\\bvar\\b", "\\byield\\b", "\\brecord\\b", "\\bsealed\\b",
-        "\\bpermits\\b", "\\bnon-sealed\\b", "\\bmodule\\b", "\\bopen\\b", 
-        "\\brequires\\b", "\\bexports\\b", "\\bopens\\b", "\\bto\\b", "\\buses\\b", 
-        "\\bprovides\\b", "\\bwith\\b"
+        "\\bnon-sealed\\b"
     };
     
     // Create rules for each keyword
+    addKeywords(keywordTable, keywordFormat);
     for (const QString &pattern : keywordPatterns) {
         HighlightingRule rule;
         rule.pattern = QRegularExpression(pattern);
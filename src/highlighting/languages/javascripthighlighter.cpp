@@ -33,41 +33,29 @@ JavaScriptLanguage::JavaScriptLanguage()
     m_multiLineCommentFormat.setForeground(Qt::darkGreen);
     
     // Define JavaScript keywords
-    const QStringList keywordPatterns = {
-        "\\bbreak\\b", "\\bcase\\b", "\\bcatch\\b", "\\bclass\\b", "\\bconst\\b",
-        "\\bcontinue\\b", "\\bdebugger\\b", "\\bdefault\\b", "\\bdelete\\b", "\\bdo\\b",
-        "\\belse\\b", "\\benum\\b", "\\bexport\\b", "\\bextends\\b", "\\bfalse\\b",
-        "\\bfinally\\b", "\\bfor\\b", "\\bfunction\\b", "\\bif\\b", "\\bimport\\b",
-        "\\bin\\b", "\\binstanceof\\b", "\\bnew\\b", "\\bnull\\b", "\\breturn\\b",
-        "\\bsuper\\b", "\\bswitch\\b", "\\bthis\\b", "\\bthrow\\b", "\\btrue\\b",
-        "\\btry\\b", "\\btypeof\\b", "\\bvar\\b", "\\bvoid\\b", "\\bwhile\\b",
-        "\\bwith\\b", "\\byield\\b", "\\blet\\b", "\\bstatic\\b", "\\bawait\\b",
-        "\\basync\\b", "\\bget\\b", "\\bset\\b", "\\bof\\b", "\\bfrom\\b"
+    static constexpr std::string_view keywords[] = {
+        "break", "case", "catch", "class", "const", "continue", "debugger",
+        "default", "delete", "do", "else", "enum", "export", "extends", "false",
+        "finally", "for", "function", "if", "import", "in", "instanceof", "new",
+        "null", "return", "super", "switch", "this", "throw", "true", "try",
+        "typeof", "var", "void", "while", "with", "yield", "let", "static", "await",
+        "async", "get", "set", "of", "from"
     };
+    static constexpr auto keywordTable = makeKeywordTable(keywords);
     
     // JavaScript global objects and properties
-    const QStringList globalObjectPatterns = {
-        "\\bArray\\b", "\\bBoolean\\b", "\\bDate\\b", "\\bError\\b", "\\bJSON\\b",
-        "\\bMath\\b", "\\bNumber\\b", "\\bObject\\b", "\\bPromise\\b", "\\bRegExp\\b",
-        "\\bString\\b", "\\bconsole\\b", "\\bdocument\\b", "\\bwindow\\b", "\\bglobal\\b",
-        "\\bMap\\b", "\\bSet\\b", "\\bSymbol\\b", "\\bWeakMap\\b", "\\bWeakSet\\b"
+    static constexpr std::string_view globalObjects[] = {
+        "Array", "Boolean", "Date", "Error", "JSON", "Math", "Number", "Object",
+        "Promise", "RegExp", "String", "console", "document", "window", "global",
+        "Map", "Set", "Symbol", "WeakMap", "WeakSet"
     };
+    static constexpr auto globalObjectTable = makeKeywordTable(globalObjects);
     
     // Create rules for each keyword
-    for (const QString &pattern : keywordPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = keywordFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(keywordTable, keywordFormat);
     
     // Create rules for global objects
-    for (const QString &pattern : globalObjectPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = globalObjectsFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(globalObjectTable, globalObjectsFormat);
     
     // Single-line comments
     HighlightingRule rule;
@@ -38,25 +38,25 @@ KotlinLanguage::KotlinLanguage()
     m_multiLineCommentFormat.setForeground(Qt::darkGreen);
     
     // Define Kotlin keywords
+    static constexpr std::string_view keywords[] = {
+        "as", "break", "class", "continue", "do", "else", "false", "for", "fun",
+        "if", "in", "interface", "is", "null", "object", "package", "return",
+        "super", "this", "throw", "true", "try", "typealias", "val", "var", "when",
+        "while", "by", "catch", "constructor", "delegates", "dynamic", "field",
+        "file", "finally", "get", "import", "init", "param", "property", "receiver",
+        "set", "setparam", "where", "actual", "abstract", "annotation", "companion",
+        "const", "crossinline", "data", "enum", "expect", "external", "final",
+        "infix", "inline", "inner", "internal", "lateinit", "noinline", "open",
+        "operator", "out", "override", "private", "protected", "public", "reified",
+        "sealed", "suspend", "tailrec", "vararg"
+    };
+    static constexpr auto keywordTable = makeKeywordTable(keywords);
     const QStringList keywordPatterns = {
-        "\\bas\\b", "\\bas?\\b", "\\bbreak\\b", "\\bclass\\b", "\\bcontinue\\b",
-        "\\bdo\\b", "\\belse\\b", "\\bfalse\\b", "\\bfor\\b", "\\bfun\\b",
-        "\\bif\\b", "\\bin\\b", "\\bin\\?\\b", "\\binterface\\b", "\\bis\\b", "\\bis!\\b",
-        "\\bnull\\b", "\\bobject\\b", "\\bpackage\\b", "\\breturn\\b", "\\bsuper\\b",
-        "\\bthis\\b", "\\bthrow\\b", "\\btrue\\b", "\\btry\\b", "\\btypealias\\b",
-        "\\bval\\b", "\\bvar\\b", "\\bwhen\\b", "\\bwhile\\b", "\\bby\\b", "\\bcatch\\b",
-        "\\bconstructor\\b", "\\bdelegates\\b", "\\bdynamic\\b", "\\bfield\\b",
-        "\\bfile\\b", "\\bfinally\\b", "\\bget\\b", "\\bimport\\b", "\\binit\\b",
-        "\\bparam\\b", "\\bproperty\\b", "\\breceiver\\b", "\\bset\\b", "\\bsetparam\\b",
-        "\\bwhere\\b", "\\bactual\\b", "\\babstract\\b", "\\bannotation\\b", "\\bcompanion\\b",
-        "\\bconst\\b", "\\bcrossinline\\b", "\\bdata\\b", "\\benum\\b", "\\bexpect\\b",
-        "\\bexternal\\b", "\\bfinal\\b", "\\binfix\\b", "\\binline\\b", "\\binner\\b",
-        "\\binternal\\b", "\\blateinit\\b", "\\bnoinline\\b", "\\bopen\\b", "\\boperator\\b",
-        "\\bout\\b", "\\boverride\\b", "\\bprivate\\b", "\\bprotected\\b", "\\bpublic\\b",
-        "\\breified\\b", "\\bsealed\\b", "\\bsuspend\\b", "\\btailrec\\b", "\\bvararg\\b"
+        "\\bas?\\b", "\\bin\\?\\b", "\\bis!\\b"
     };
     
     // Create rules for each keyword
+    addKeywords(keywordTable, keywordFormat);
     for (const QString &pattern : keywordPatterns) {
         HighlightingRule rule;
         rule.pattern = QRegularExpression(pattern);
@@ -28,35 +28,31 @@ LuaLanguage::LuaLanguage()
     numberFormat.setForeground(QColor(125, 80, 0)); // Dark brown
     
     // Lua keywords
-    const QStringList keywordPatterns = {
-        "\\band\\b", "\\bbreak\\b", "\\bdo\\b", "\\belse\\b", "\\belseif\\b",
-        "\\bend\\b", "\\bfalse\\b", "\\bfor\\b", "\\bfunction\\b", "\\bgoto\\b",
-        "\\bif\\b", "\\bin\\b", "\\blocal\\b", "\\bnil\\b", "\\bnot\\b",
-        "\\bor\\b", "\\brepeat\\b", "\\breturn\\b", "\\bthen\\b", "\\btrue\\b",
-        "\\buntil\\b", "\\bwhile\\b"
+    static constexpr std::string_view keywords[] = {
+        "and", "break", "do", "else", "elseif", "end", "false", "for", "function",
+        "goto", "if", "in", "local", "nil", "not", "or", "repeat", "return", "then",
+        "true", "until", "while"
     };
+    static constexpr auto keywordTable = makeKeywordTable(keywords);
     
-    for (const QString &pattern : keywordPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = keywordFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(keywordTable, keywordFormat);
     
     // Lua built-in functions and libraries
+    static constexpr std::string_view builtIns[] = {
+        "print", "tonumber", "tostring", "type", "select", "next", "pairs",
+        "ipairs", "pcall", "xpcall", "require", "dofile", "loadfile", "loadstring",
+        "setmetatable", "getmetatable", "rawequal", "rawget", "rawset",
+        "collectgarbage"
+    };
+    static constexpr auto builtInTable = makeKeywordTable(builtIns);
     const QStringList builtInPatterns = {
-        // Standard library
-        "\\bprint\\b", "\\btonumber\\b", "\\btostring\\b", "\\btype\\b", "\\bselect\\b",
-        "\\bnext\\b", "\\bpairs\\b", "\\bipairs\\b", "\\bpcall\\b", "\\bxpcall\\b",
-        "\\brequire\\b", "\\bdofile\\b", "\\bloadfile\\b", "\\bloadstring\\b", "\\bsetmetatable\\b",
-        "\\bgetmetatable\\b", "\\brawequal\\b", "\\brawget\\b", "\\brawset\\b", "\\bcollectgarbage\\b",
-        
-        // Libraries
-        "\\bstring\\.\\w+\\b", "\\btable\\.\\w+\\b", "\\bmath\\.\\w+\\b", 
-        "\\bio\\.\\w+\\b", "\\bos\\.\\w+\\b", "\\bcoroutine\\.\\w+\\b", 
-        "\\bdebug\\.\\w+\\b", "\\bpackage\\.\\w+\\b", "\\bbit32\\.\\w+\\b", "\\butf8\\.\\w+\\b"
+        "\\bstring\\.\\w+\\b", "\\btable\\.\\w+\\b", "\\bmath\\.\\w+\\b",
+        "\\bio\\.\\w+\\b", "\\bos\\.\\w+\\b", "\\bcoroutine\\.\\w+\\b",
+        "\\bdebug\\.\\w+\\b", "\\bpackage\\.\\w+\\b", "\\bbit32\\.\\w+\\b",
+        "\\butf8\\.\\w+\\b"
     };
     
+    addKeywords(builtInTable, builtInFormat);
     for (const QString &pattern : builtInPatterns) {
         HighlightingRule rule;
         rule.pattern = QRegularExpression(pattern);
@@ -38,40 +38,39 @@ ObjCLanguage::ObjCLanguage()
     m_multiLineCommentFormat.setForeground(Qt::darkGreen);
     
     // Define C/C++ keywords (shared with Objective-C)
-    const QStringList keywordPatterns = {
-        "\\bbreak\\b", "\\bcase\\b", "\\bchar\\b", "\\bconst\\b", "\\bcontinue\\b",
-        "\\bdefault\\b", "\\bdo\\b", "\\bdouble\\b", "\\belse\\b", "\\benum\\b",
-        "\\bextern\\b", "\\bfloat\\b", "\\bfor\\b", "\\bgoto\\b", "\\bif\\b",
-        "\\bint\\b", "\\blong\\b", "\\bregister\\b", "\\breturn\\b", "\\bshort\\b",
-        "\\bsigned\\b", "\\bsizeof\\b", "\\bstatic\\b", "\\bstruct\\b", "\\bswitch\\b",
-        "\\btypedef\\b", "\\bunion\\b", "\\bunsigned\\b", "\\bvoid\\b", "\\bvolatile\\b",
-        "\\bwhile\\b", "\\bauto\\b", "\\bconst\\b", "\\binline\\b"
+    static constexpr std::string_view keywords[] = {
+        "break", "case", "char", "const", "continue", "default", "do", "double",
+        "else", "enum", "extern", "float", "for", "goto", "if", "int", "long",
+        "register", "return", "short", "signed", "sizeof", "static", "struct",
+        "switch", "typedef", "union", "unsigned", "void", "volatile", "while",
+        "auto", "const", "inline"
     };
+    static constexpr auto keywordTable = makeKeywordTable(keywords);
     
     // Objective-C specific keywords
+    static constexpr std::string_view objcKeywords[] = {
+        "id", "self", "super", "_cmd", "NO", "YES", "nil", "NULL", "SEL",
+        "unsafe_unretained", "weak", "strong", "retain", "nonatomic", "atomic",
+        "readonly", "readwrite", "copy", "assign", "NSObject", "NSString",
+        "NSArray", "NSDictionary", "NSNumber", "NS_ENUM", "NS_OPTIONS", "in", "out",
+        "inout"
+    };
+    static constexpr auto objcKeywordTable = makeKeywordTable(objcKeywords);
     const QStringList objcKeywordPatterns = {
-        "\\b@interface\\b", "\\b@implementation\\b", "\\b@protocol\\b", "\\b@end\\b",
-        "\\b@private\\b", "\\b@protected\\b", "\\b@public\\b", "\\b@try\\b", "\\b@catch\\b",
-        "\\b@finally\\b", "\\b@throw\\b", "\\b@synthesize\\b", "\\b@dynamic\\b", 
-        "\\b@property\\b", "\\bid\\b", "\\b@selector\\b", "\\b@class\\b", "\\b@encode\\b",
-        "\\bself\\b", "\\bsuper\\b", "\\b_cmd\\b", "\\b@synchronized\\b", "\\b@autoreleasepool\\b",
-        "\\b@YES\\b", "\\b@NO\\b", "\\b@true\\b", "\\b@false\\b", "\\bNO\\b", "\\bYES\\b",
-        "\\bnil\\b", "\\bNULL\\b", "\\bSEL\\b", "\\bunsafe_unretained\\b", "\\bweak\\b",
-        "\\bstrong\\b", "\\bretain\\b", "\\bnonatomic\\b", "\\batomic\\b", "\\breadonly\\b",
-        "\\breadwrite\\b", "\\bcopy\\b", "\\bassign\\b", "\\bNSObject\\b", "\\bNSString\\b",
-        "\\bNSArray\\b", "\\bNSDictionary\\b", "\\bNSNumber\\b", "\\b@import\\b", "\\b@optional\\b",
-        "\\b@required\\b", "\\bNS_ENUM\\b", "\\bNS_OPTIONS\\b", "\\bin\\b", "\\bout\\b", "\\binout\\b"
+        "\\b@interface\\b", "\\b@implementation\\b", "\\b@protocol\\b",
+        "\\b@end\\b", "\\b@private\\b", "\\b@protected\\b", "\\b@public\\b",
+        "\\b@try\\b", "\\b@catch\\b", "\\b@finally\\b", "\\b@throw\\b",
+        "\\b@synthesize\\b", "\\b@dynamic\\b", "\\b@property\\b", "\\b@selector\\b",
+        "\\b@class\\b", "\\b@encode\\b", "\\b@synchronized\\b",
+        "\\b@autoreleasepool\\b", "\\b@YES\\b", "\\b@NO\\b", "\\b@true\\b",
+        "\\b@false\\b", "\\b@import\\b", "\\b@optional\\b", "\\b@required\\b"
     };
     
     // Create rules for each C/C++ keyword
-    for (const QString &pattern : keywordPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = keywordFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(keywordTable, keywordFormat);
     
     // Create rules for each Objective-C keyword
+    addKeywords(objcKeywordTable, objcSpecificFormat);
     for (const QString &pattern : objcKeywordPatterns) {
         HighlightingRule rule;
         rule.pattern = QRegularExpression(pattern);
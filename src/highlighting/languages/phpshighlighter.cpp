@@ -44,49 +44,35 @@ PhpLanguage::PhpLanguage()
     m_highlightingRules.append(rule);
     
     // PHP keywords
-    const QStringList keywordPatterns = {
-        "\\barray\\b", "\\bas\\b", "\\bbreak\\b", "\\bcase\\b", "\\bcatch\\b", 
-        "\\bclass\\b", "\\bclone\\b", "\\bconst\\b", "\\bcontinue\\b", "\\bdeclare\\b", 
-        "\\bdefault\\b", "\\bdo\\b", "\\becho\\b", "\\belse\\b", "\\belseif\\b", 
-        "\\bempty\\b", "\\benddeclare\\b", "\\bendfor\\b", "\\bendforeach\\b", 
-        "\\bendif\\b", "\\bendswitch\\b", "\\bendwhile\\b", "\\bextends\\b", 
-        "\\bfinal\\b", "\\bfinally\\b", "\\bfor\\b", "\\bforeach\\b", "\\bfunction\\b", 
-        "\\bglobal\\b", "\\bif\\b", "\\bimplements\\b", "\\binclude\\b", "\\binclude_once\\b", 
-        "\\binstanceof\\b", "\\binsteadof\\b", "\\binterface\\b", "\\bisset\\b", 
-        "\\blist\\b", "\\bnamespace\\b", "\\bnew\\b", "\\bor\\b", "\\bprint\\b", 
-        "\\bprivate\\b", "\\bprotected\\b", "\\bpublic\\b", "\\brequire\\b", 
-        "\\brequire_once\\b", "\\breturn\\b", "\\bstatic\\b", "\\bswitch\\b", 
-        "\\bthrow\\b", "\\btrait\\b", "\\btry\\b", "\\bunset\\b", "\\buse\\b", 
-        "\\bvar\\b", "\\bwhile\\b", "\\byield\\b", "\\bfn\\b", "\\bmatch\\b",
-        "\\benum\\b", "\\bfalse\\b", "\\bnull\\b", "\\btrue\\b", "\\band\\b",
-        "\\bxor\\b", "\\bdie\\b", "\\bself\\b", "\\bparent\\b", "\\breadonly\\b"
+    static constexpr std::string_view keywords[] = {
+        "array", "as", "break", "case", "catch", "class", "clone", "const",
+        "continue", "declare", "default", "do", "echo", "else", "elseif", "empty",
+        "enddeclare", "endfor", "endforeach", "endif", "endswitch", "endwhile",
+        "extends", "final", "finally", "for", "foreach", "function", "global", "if",
+        "implements", "include", "include_once", "instanceof", "insteadof",
+        "interface", "isset", "list", "namespace", "new", "or", "print", "private",
+        "protected", "public", "require", "require_once", "return", "static",
+        "switch", "throw", "trait", "try", "unset", "use", "var", "while", "yield",
+        "fn", "match", "enum", "false", "null", "true", "and", "xor", "die", "self",
+        "parent", "readonly"
     };
+    static constexpr auto keywordTable = makeKeywordTable(keywords);
     
     // Create rules for each keyword
-    for (const QString &pattern : keywordPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = keywordFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(keywordTable, keywordFormat);
     
     // PHP built-in functions (sample of common ones)
-    const QStringList builtInPatterns = {
-        "\\bstr_replace\\b", "\\bstrlen\\b", "\\barray_push\\b", "\\bcount\\b",
-        "\\bdate\\b", "\\btime\\b", "\\bmysqli_connect\\b", "\\bmysqli_query\\b",
-        "\\bmysqli_fetch_assoc\\b", "\\bfile_get_contents\\b", "\\bfile_put_contents\\b",
-        "\\bjson_encode\\b", "\\bjson_decode\\b", "\\bpreg_match\\b", "\\bpreg_replace\\b",
-        "\\bsprintf\\b", "\\bsubstr\\b", "\\bexplode\\b", "\\bimplode\\b", "\\btrim\\b",
-        "\\bheader\\b", "\\bsession_start\\b", "\\bintval\\b", "\\bfloatval\\b"
+    static constexpr std::string_view builtIns[] = {
+        "str_replace", "strlen", "array_push", "count", "date", "time",
+        "mysqli_connect", "mysqli_query", "mysqli_fetch_assoc", "file_get_contents",
+        "file_put_contents", "json_encode", "json_decode", "preg_match",
+        "preg_replace", "sprintf", "substr", "explode", "implode", "trim", "header",
+        "session_start", "intval", "floatval"
     };
+    static constexpr auto builtInTable = makeKeywordTable(builtIns);
     
     // Create rules for built-in functions
-    for (const QString &pattern : builtInPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = builtInFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(builtInTable, builtInFormat);
     
     // Variables
     rule.pattern = QRegularExpression("\\$[a-zA-Z_][a-zA-Z0-9_]*\\b");
@@ -34,49 +34,33 @@ PythonLanguage::PythonLanguage()
     numberFormat.setForeground(QColor(125, 80, 0)); // Dark brown
     
     // Define Python keywords
-    const QStringList keywordPatterns = {
-        "\\band\\b", "\\bas\\b", "\\bassert\\b", "\\bbreak\\b", "\\bclass\\b",
-        "\\bcontinue\\b", "\\bdef\\b", "\\bdel\\b", "\\belif\\b", "\\belse\\b",
-        "\\bexcept\\b", "\\bfinally\\b", "\\bfor\\b", "\\bfrom\\b", "\\bglobal\\b",
-        "\\bif\\b", "\\bimport\\b", "\\bin\\b", "\\bis\\b", "\\blambda\\b",
-        "\\bnonlocal\\b", "\\bnot\\b", "\\bor\\b", "\\bpass\\b", "\\braise\\b",
-        "\\breturn\\b", "\\btry\\b", "\\bwhile\\b", "\\bwith\\b", "\\byield\\b",
-        "\\bTrue\\b", "\\bFalse\\b", "\\bNone\\b", "\\basync\\b", "\\bawait\\b"
+    static constexpr std::string_view keywords[] = {
+        "and", "as", "assert", "break", "class", "continue", "def", "del", "elif",
+        "else", "except", "finally", "for", "from", "global", "if", "import", "in",
+        "is", "lambda", "nonlocal", "not", "or", "pass", "raise", "return", "try",
+        "while", "with", "yield", "True", "False", "None", "async", "await"
     };
+    static constexpr auto keywordTable = makeKeywordTable(keywords);
     
     // Python built-in functions
-    const QStringList builtinPatterns = {
-        "\\babs\\b", "\\ball\\b", "\\bany\\b", "\\bascii\\b", "\\bbin\\b",
-        "\\bbool\\b", "\\bbytearray\\b", "\\bbytes\\b", "\\bcallable\\b",
-        "\\bchr\\b", "\\bclassmethod\\b", "\\bcompile\\b", "\\bcomplex\\b",
-        "\\bdict\\b", "\\bdir\\b", "\\bdivmod\\b", "\\benumerate\\b", "\\beval\\b",
-        "\\bexec\\b", "\\bfilter\\b", "\\bfloat\\b", "\\bformat\\b", "\\bfrozenset\\b",
-        "\\bgetattr\\b", "\\bglobals\\b", "\\bhasattr\\b", "\\bhash\\b", "\\bhelp\\b",
-        "\\bhex\\b", "\\bid\\b", "\\binput\\b", "\\bint\\b", "\\bisinstance\\b",
-        "\\bissubclass\\b", "\\biter\\b", "\\blen\\b", "\\blist\\b", "\\blocals\\b",
-        "\\bmap\\b", "\\bmax\\b", "\\bmemoryview\\b", "\\bmin\\b", "\\bnext\\b",
-        "\\bobject\\b", "\\boct\\b", "\\bopen\\b", "\\bord\\b", "\\bpow\\b",
-        "\\bprint\\b", "\\bproperty\\b", "\\brange\\b", "\\brepr\\b", "\\breversed\\b",
-        "\\bround\\b", "\\bset\\b", "\\bsetattr\\b", "\\bslice\\b", "\\bsorted\\b",
-        "\\bstaticmethod\\b", "\\bstr\\b", "\\bsum\\b", "\\bsuper\\b", "\\btuple\\b",
-        "\\btype\\b", "\\bvars\\b", "\\bzip\\b", "\\b__import__\\b"
+    static constexpr std::string_view builtins[] = {
+        "abs", "all", "any", "ascii", "bin", "bool", "bytearray", "bytes",
+        "callable", "chr", "classmethod", "compile", "complex", "dict", "dir",
+        "divmod", "enumerate", "eval", "exec", "filter", "float", "format",
+        "frozenset", "getattr", "globals", "hasattr", "hash", "help", "hex", "id",
+        "input", "int", "isinstance", "issubclass", "iter", "len", "list", "locals",
+        "map", "max", "memoryview", "min", "next", "object", "oct", "open", "ord",
+        "pow", "print", "property", "range", "repr", "reversed", "round", "set",
+        "setattr", "slice", "sorted", "staticmethod", "str", "sum", "super",
+        "tuple", "type", "vars", "zip", "__import__"
     };
+    static constexpr auto builtinTable = makeKeywordTable(builtins);
     
     // Create rules for each keyword
-    for (const QString &pattern : keywordPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = keywordFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(keywordTable, keywordFormat);
     
     // Create rules for built-in functions
-    for (const QString &pattern : builtinPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = builtinsFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(builtinTable, builtinsFormat);
     
     // 'self' parameter
     HighlightingRule rule;
@@ -126,9 +110,22 @@ PythonLanguage::PythonLanguage()
     rule.format = numberFormat;
     m_highlightingRules.append(rule);
     
-    // Python multiline strings don't use the C-style /* */ syntax,
-    // but we'll implement it for consistent behavior with docstrings
-    m_multiLineCommentFormat.setForeground(Qt::darkGreen);
-    m_commentStartExpression = QRegularExpression("(\"\"\"|\'\'\')");
-    m_commentEndExpression = QRegularExpression("(\"\"\"|\'\'\')");
+    // No multi-line comments in Python
+    m_commentStartExpression = QRegularExpression("(?!)"); // Valid pattern that never matches
+    m_commentEndExpression = QRegularExpression("(?!)");   // Valid pattern that never matches
+    
+    // Triple-quoted strings, shown like comments as they are mostly
+    // docstrings; each kind is only closed by its own quotes
+    QTextCharFormat docstringFormat;
+    docstringFormat.setForeground(Qt::darkGreen);
+    
+    BlockRegion tripleQuoted;
+    tripleQuoted.start = QRegularExpression("[rRbBuUfF]{0,2}\"\"\"");
+    tripleQuoted.end = QRegularExpression("(?<!\\\\)\"\"\"");
+    tripleQuoted.format = docstringFormat;
+    m_blockRegions.append(tripleQuoted);
+    
+    tripleQuoted.start = QRegularExpression("[rRbBuUfF]{0,2}'''");
+    tripleQuoted.end = QRegularExpression("(?<!\\\\)'''");
+    m_blockRegions.append(tripleQuoted);
 }
@@ -44,26 +44,18 @@ RubyLanguage::RubyLanguage()
     regexpFormat.setForeground(QColor(210, 65, 30)); // Orange-red
     
     // Ruby keywords
-    const QStringList keywordPatterns = {
-        "\\balias\\b", "\\band\\b", "\\bbegin\\b", "\\bbreak\\b", "\\bcase\\b", 
-        "\\bclass\\b", "\\bdef\\b", "\\bdefined\\b", "\\bdo\\b", "\\belse\\b", 
-        "\\belsif\\b", "\\bend\\b", "\\bensure\\b", "\\bfalse\\b", "\\bfor\\b", 
-        "\\bif\\b", "\\bin\\b", "\\bmodule\\b", "\\bnext\\b", "\\bnil\\b", 
-        "\\bnot\\b", "\\bor\\b", "\\bredo\\b", "\\brescue\\b", "\\bretry\\b", 
-        "\\breturn\\b", "\\bself\\b", "\\bsuper\\b", "\\bthen\\b", "\\btrue\\b", 
-        "\\bundef\\b", "\\bunless\\b", "\\buntil\\b", "\\bwhen\\b", "\\bwhile\\b", 
-        "\\byield\\b", "\\brequire\\b", "\\binclude\\b", "\\bextend\\b", "\\battr_reader\\b", 
-        "\\battr_writer\\b", "\\battr_accessor\\b", "\\bprivate\\b", "\\bprotected\\b", 
-        "\\bpublic\\b", "\\braise\\b", "\\bcatch\\b", "\\bthrow\\b", "\\bproc\\b", 
-        "\\blambda\\b"
+    static constexpr std::string_view keywords[] = {
+        "alias", "and", "begin", "break", "case", "class", "def", "defined", "do",
+        "else", "elsif", "end", "ensure", "false", "for", "if", "in", "module",
+        "next", "nil", "not", "or", "redo", "rescue", "retry", "return", "self",
+        "super", "then", "true", "undef", "unless", "until", "when", "while",
+        "yield", "require", "include", "extend", "attr_reader", "attr_writer",
+        "attr_accessor", "private", "protected", "public", "raise", "catch",
+        "throw", "proc", "lambda"
     };
+    static constexpr auto keywordTable = makeKeywordTable(keywords);
     
-    for (const QString &pattern : keywordPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = keywordFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(keywordTable, keywordFormat);
     
     // Class and module names
     HighlightingRule rule;
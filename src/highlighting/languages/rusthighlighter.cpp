@@ -40,24 +40,17 @@ RustLanguage::RustLanguage()
     m_multiLineCommentFormat.setForeground(Qt::darkGreen);
     
     // Define Rust keywords
-    const QStringList keywordPatterns = {
-        "\\bas\\b", "\\basync\\b", "\\bawait\\b", "\\bbreak\\b", "\\bconst\\b", 
-        "\\bcontinue\\b", "\\bcrate\\b", "\\bdyn\\b", "\\belse\\b", "\\benum\\b", 
-        "\\bextern\\b", "\\bfalse\\b", "\\bfn\\b", "\\bfor\\b", "\\bif\\b", 
-        "\\bimpl\\b", "\\bin\\b", "\\blet\\b", "\\bloop\\b", "\\bmatch\\b", 
-        "\\bmod\\b", "\\bmove\\b", "\\bmut\\b", "\\bpub\\b", "\\bref\\b", 
-        "\\breturn\\b", "\\bself\\b", "\\bSelf\\b", "\\bstatic\\b", "\\bstruct\\b", 
-        "\\bsuper\\b", "\\btrait\\b", "\\btrue\\b", "\\btype\\b", "\\bunion\\b", 
-        "\\bunsafe\\b", "\\buse\\b", "\\bwhere\\b", "\\bwhile\\b", "\\byield\\b"
+    static constexpr std::string_view keywords[] = {
+        "as", "async", "await", "break", "const", "continue", "crate", "dyn",
+        "else", "enum", "extern", "false", "fn", "for", "if", "impl", "in", "let",
+        "loop", "match", "mod", "move", "mut", "pub", "ref", "return", "self",
+        "Self", "static", "struct", "super", "trait", "true", "type", "union",
+        "unsafe", "use", "where", "while", "yield"
     };
+    static constexpr auto keywordTable = makeKeywordTable(keywords);
     
     // Create rules for each keyword
-    for (const QString &pattern : keywordPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = keywordFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(keywordTable, keywordFormat);
     
     // Type names (start with capital letter)
     HighlightingRule rule;
@@ -106,7 +99,15 @@ RustLanguage::RustLanguage()
     rule.format = lifetimeFormat;
     m_highlightingRules.append(rule);
     
-    // Multi-line comment expressions
+    // Multi-line comment expressions; block comments nest in Rust
     m_commentStartExpression = QRegularExpression("/\\*");
     m_commentEndExpression = QRegularExpression("\\*/");
+    m_nestedComments = true;
+    
+    // Raw strings, closed by a quote and as many # as they opened with
+    BlockRegion rawString;
+    rawString.start = QRegularExpression("\\bb?r(?<delimiter>#*)\"");
+    rawString.endPattern = "\"%1";
+    rawString.format = quotationFormat;
+    m_blockRegions.append(rawString);
 }
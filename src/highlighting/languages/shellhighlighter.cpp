@@ -1,5 +1,38 @@
 #include "shellhighlighter.h"
 
+namespace {
+
+// << only opens a here-document where a command is expected. Inside an
+// arithmetic (( )) or $(( )) it is a shift, and so it is after a number
+// standing on its own, as in 1 << n; a number written against it, as in
+// 3<<EOF, is a file descriptor.
+bool isHereDocumentStart(const QString &text, int start)
+{
+    int arithmetic = 0;
+    for (int i = 0; i + 1 < start; ++i) {
+        if (text.at(i) == QLatin1Char('(') && text.at(i + 1) == QLatin1Char('(')) {
+            ++arithmetic;
+            ++i;
+        } else if (text.at(i) == QLatin1Char(')') && text.at(i + 1) == QLatin1Char(')') && arithmetic > 0) {
+            --arithmetic;
+            ++i;
+        }
+    }
+    if (arithmetic > 0)
+        return false;
+
+    int operand = start;
+    while (operand > 0 && text.at(operand - 1).isSpace())
+        --operand;
+    if (operand == start || operand == 0 || !text.at(operand - 1).isDigit())
+        return true;
+    while (operand > 0 && text.at(operand - 1).isDigit())
+        --operand;
+    return operand > 0 && (text.at(operand - 1).isLetterOrNumber() || text.at(operand - 1) == QLatin1Char('_'));
+}
+
+}
+
 BashLanguage::BashLanguage()
 {
     m_name = "Bash";
@@ -27,26 +60,30 @@ BashLanguage::BashLanguage()
     commandFormat.setForeground(QColor(128, 0, 128)); // Purple
     
     // Define Bash keywords and control structures
+    static constexpr std::string_view keywords[] = {
+        "if", "then", "else", "elif", "fi", "while", "do", "done", "for", "in",
+        "case", "esac", "function", "return", "local", "until", "select", "time",
+        "coproc", "test"
+    };
+    static constexpr auto keywordTable = makeKeywordTable(keywords);
     const QStringList keywordPatterns = {
-        "\\bif\\b", "\\bthen\\b", "\\belse\\b", "\\belif\\b", "\\bfi\\b", 
-        "\\bwhile\\b", "\\bdo\\b", "\\bdone\\b", "\\bfor\\b", "\\bin\\b", 
-        "\\bcase\\b", "\\besac\\b", "\\bfunction\\b", "\\breturn\\b", "\\blocal\\b",
-        "\\buntil\\b", "\\bselect\\b", "\\btime\\b", "\\bcoproc\\b", "\\b\\{\\b", 
-        "\\b\\}\\b", "\\b!\\b", "\\btest\\b", "\\b\\[\\b", "\\b\\]\\b"
+        "\\b\\{\\b", "\\b\\}\\b", "\\b!\\b", "\\b\\[\\b", "\\b\\]\\b"
     };
     
     // Common Bash commands
+    static constexpr std::string_view commands[] = {
+        "echo", "cd", "ls", "grep", "awk", "sed", "cat", "cp", "mv", "rm", "mkdir",
+        "touched", "find", "which", "export", "source", "chmod", "chown", "tail",
+        "head", "sort", "uniq", "wc", "tar", "zip", "unzip", "gzip", "gunzip",
+        "ssh", "scp", "rsync", "curl", "wget", "pwd", "xargs", "sudo", "su"
+    };
+    static constexpr auto commandTable = makeKeywordTable(commands);
     const QStringList commandPatterns = {
-        "\\becho\\b", "\\bcd\\b", "\\bls\\b", "\\bgrep\\b", "\\bawk\\b", "\\bsed\\b",
-        "\\bcat\\b", "\\bcp\\b", "\\bmv\\b", "\\brm\\b", "\\bmkdir\\b", "\\btouched\\b",
-        "\\bfind\\b", "\\bwhich\\b", "\\bexport\\b", "\\bsource\\b", "\\b\\.\\b",
-        "\\bchmod\\b", "\\bchown\\b", "\\btail\\b", "\\bhead\\b", "\\bsort\\b",
-        "\\buniq\\b", "\\bwc\\b", "\\btar\\b", "\\bzip\\b", "\\bunzip\\b", "\\bgzip\\b",
-        "\\bgunzip\\b", "\\bssh\\b", "\\bscp\\b", "\\brsync\\b", "\\bcurl\\b",
-        "\\bwget\\b", "\\bpwd\\b", "\\bxargs\\b", "\\bsudo\\b", "\\bsu\\b"
+        "\\b\\.\\b"
     };
     
     // Create rules for each keyword
+    addKeywords(keywordTable, keywordFormat);
     for (const QString &pattern : keywordPatterns) {
         HighlightingRule rule;
         rule.pattern = QRegularExpression(pattern);
@@ -55,6 +92,7 @@ BashLanguage::BashLanguage()
     }
     
     // Create rules for common commands
+    addKeywords(commandTable, commandFormat);
     for (const QString &pattern : commandPatterns) {
         HighlightingRule rule;
         rule.pattern = QRegularExpression(pattern);
@@ -89,14 +127,24 @@ BashLanguage::BashLanguage()
     rule.format = commentFormat;
     m_highlightingRules.append(rule);
     
-    // Here-documents
-    rule.pattern = QRegularExpression("<<-?\\s*['\"](\\w+)['\"]");
-    rule.format = keywordFormat;
-    m_highlightingRules.append(rule);
-    
     // No multi-line comments in Bash
     m_commentStartExpression = QRegularExpression("(?!)"); // Valid pattern that never matches
     m_commentEndExpression = QRegularExpression("(?!)");   // Valid pattern that never matches
+    
+    // Here-documents, from the line after the marker to the line holding
+    // only the delimiter. With <<- that line may be indented by tabs, but
+    // never by spaces, and nothing may follow the delimiter.
+    BlockRegion hereDocument;
+    hereDocument.start = QRegularExpression("(?<!<)<<(?!-)\\s*['\"]?(?<delimiter>[A-Za-z_][A-Za-z0-9_]*)['\"]?");
+    hereDocument.endPattern = "^%1$";
+    hereDocument.format = stringFormat;
+    hereDocument.bodyOnNextLine = true;
+    hereDocument.startAllowed = isHereDocumentStart;
+    m_blockRegions.append(hereDocument);
+    
+    hereDocument.start = QRegularExpression("(?<!<)<<-\\s*['\"]?(?<delimiter>[A-Za-z_][A-Za-z0-9_]*)['\"]?");
+    hereDocument.endPattern = "^\\t*%1$";
+    m_blockRegions.append(hereDocument);
 }
 
 PowerShellLanguage::PowerShellLanguage()
@@ -132,15 +180,16 @@ PowerShellLanguage::PowerShellLanguage()
     operatorFormat.setForeground(QColor(120, 120, 120)); // Gray
     
     // Define PowerShell keywords
+    static constexpr std::string_view keywords[] = {
+        "begin", "break", "catch", "class", "continue", "data", "define", "do",
+        "dynamicparam", "else", "elseif", "end", "exit", "filter", "finally", "for",
+        "foreach", "from", "function", "if", "in", "param", "process", "return",
+        "switch", "throw", "trap", "try", "until", "using", "var", "while",
+        "workflow", "True", "False", "Not", "And", "Or", "Xor"
+    };
+    static constexpr auto keywordTable = makeKeywordTable(keywords);
     const QStringList keywordPatterns = {
-        "\\bbegin\\b", "\\bbreak\\b", "\\bcatch\\b", "\\bclass\\b", "\\bcontinue\\b",
-        "\\bdata\\b", "\\bdefine\\b", "\\bdo\\b", "\\bdynamicparam\\b", "\\belse\\b",
-        "\\belseif\\b", "\\bend\\b", "\\bexit\\b", "\\bfilter\\b", "\\bfinally\\b",
-        "\\bfor\\b", "\\bforeach\\b", "\\bfrom\\b", "\\bfunction\\b", "\\bif\\b",
-        "\\bin\\b", "\\bparam\\b", "\\bprocess\\b", "\\breturn\\b", "\\bswitch\\b",
-        "\\bthrow\\b", "\\btrap\\b", "\\btry\\b", "\\buntil\\b", "\\busing\\b",
-        "\\bvar\\b", "\\bwhile\\b", "\\bworkflow\\b", "\\bTrue\\b", "\\bFalse\\b",
-        "\\b\\.\\b", "\\bNot\\b", "\\bAnd\\b", "\\bOr\\b", "\\bXor\\b"
+        "\\b\\.\\b"
     };
     
     // Common PowerShell cmdlets
@@ -154,6 +203,7 @@ PowerShellLanguage::PowerShellLanguage()
     };
     
     // Create rules for each keyword
+    addKeywords(keywordTable, keywordFormat);
     for (const QString &pattern : keywordPatterns) {
         HighlightingRule rule;
         rule.pattern = QRegularExpression(pattern);
@@ -245,40 +295,27 @@ BatchLanguage::BatchLanguage()
     commandFormat.setForeground(QColor(170, 40, 0)); // Rust/brown color
     
     // Define batch file keywords and commands
-    const QStringList keywordPatterns = {
-        "\\bif\\b", "\\bgoto\\b", "\\bcall\\b", "\\becho\\b", "\\belse\\b", 
-        "\\bendlocal\\b", "\\berrorlevel\\b", "\\bexist\\b", "\\bexit\\b", 
-        "\\bfor\\b", "\\bin\\b", "\\bdo\\b", "\\bnot\\b", "\\bsetlocal\\b", 
-        "\\bshift\\b", "\\brem\\b", "\\bthen\\b", "\\bset\\b"
+    static constexpr std::string_view keywords[] = {
+        "if", "goto", "call", "echo", "else", "endlocal", "errorlevel", "exist",
+        "exit", "for", "in", "do", "not", "setlocal", "shift", "rem", "then", "set"
     };
+    static constexpr auto keywordTable = makeKeywordTable(keywords, CaseInsensitive);
     
     // Common batch commands
-    const QStringList commandPatterns = {
-        "\\bcopy\\b", "\\bdel\\b", "\\bren\\b", "\\bmove\\b", "\\bdir\\b",
-        "\\bmd\\b", "\\bmkdir\\b", "\\brd\\b", "\\brmdir\\b", "\\btype\\b",
-        "\\bpause\\b", "\\bcls\\b", "\\bfindstr\\b", "\\bfind\\b", "\\bchdir\\b",
-        "\\bcd\\b", "\\bdate\\b", "\\btime\\b", "\\blive\\b", "\\bstart\\b",
-        "\\btasklist\\b", "\\btaskkill\\b", "\\bsc\\b", "\\bnet\\b", "\\bipconfig\\b",
-        "\\bping\\b", "\\bwmic\\b", "\\bnslookup\\b", "\\btracert\\b", "\\bnetstat\\b",
-        "\\bxcopy\\b", "\\battrib\\b", "\\bchkdsk\\b", "\\bcomp\\b", "\\bfc\\b",
-        "\\bpushd\\b", "\\bpopd\\b"
+    static constexpr std::string_view commands[] = {
+        "copy", "del", "ren", "move", "dir", "md", "mkdir", "rd", "rmdir", "type",
+        "pause", "cls", "findstr", "find", "chdir", "cd", "date", "time", "live",
+        "start", "tasklist", "taskkill", "sc", "net", "ipconfig", "ping", "wmic",
+        "nslookup", "tracert", "netstat", "xcopy", "attrib", "chkdsk", "comp", "fc",
+        "pushd", "popd"
     };
+    static constexpr auto commandTable = makeKeywordTable(commands, CaseInsensitive);
 
     // Create rules for each keyword
-    for (const QString &pattern : keywordPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern, QRegularExpression::CaseInsensitiveOption);
-        rule.format = keywordFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(keywordTable, keywordFormat);
     
     // Create rules for common commands
-    for (const QString &pattern : commandPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern, QRegularExpression::CaseInsensitiveOption);
-        rule.format = commandFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(commandTable, commandFormat);
     
     // Labels (lines starting with : and no whitespace)
     HighlightingRule rule;
@@ -33,69 +33,47 @@ SqlLanguage::SqlLanguage()
     specialFormat.setForeground(QColor(150, 20, 100)); // Reddish-purple
     
     // Define SQL keywords
-    const QStringList keywordPatterns = {
-        "\\bADD\\b", "\\bALL\\b", "\\bALTER\\b", "\\bAND\\b", "\\bANY\\b", "\\bAS\\b", 
-        "\\bASC\\b", "\\bBACKUP\\b", "\\bBETWEEN\\b", "\\bBY\\b", "\\bCASE\\b", 
-        "\\bCHECK\\b", "\\bCLUSTER\\b", "\\bCOLUMN\\b", "\\bCONSTRAINT\\b", 
-        "\\bCREATE\\b", "\\bCROSS\\b", "\\bCURRENT_DATE\\b", "\\bCURRENT_TIME\\b", 
-        "\\bCURRENT_TIMESTAMP\\b", "\\bCURRENT_USER\\b", "\\bDATABASE\\b", 
-        "\\bDEFAULT\\b", "\\bDELETE\\b", "\\bDESC\\b", "\\bDISTINCT\\b", "\\bDROP\\b", 
-        "\\bEACH\\b", "\\bELSE\\b", "\\bEND\\b", "\\bEXCEPT\\b", "\\bEXISTS\\b", 
-        "\\bFOREIGN\\b", "\\bFROM\\b", "\\bFULL\\b", "\\bGRANT\\b", "\\bGROUP\\b", 
-        "\\bHAVING\\b", "\\bIN\\b", "\\bINDEX\\b", "\\bINNER\\b", "\\bINSERT\\b", 
-        "\\bINTERSECT\\b", "\\bINTO\\b", "\\bIS\\b", "\\bJOIN\\b", "\\bKEY\\b", 
-        "\\bLEFT\\b", "\\bLIKE\\b", "\\bLIMIT\\b", "\\bNOT\\b", "\\bNULL\\b", 
-        "\\bOFFSET\\b", "\\bON\\b", "\\bOR\\b", "\\bORDER\\b", "\\bOUTER\\b", 
-        "\\bPRIMARY\\b", "\\bPROCEDURE\\b", "\\bREFERENCES\\b", "\\bRIGHT\\b", 
-        "\\bROLLBACK\\b", "\\bROW\\b", "\\bSELECT\\b", "\\bSET\\b", "\\bSOME\\b", 
-        "\\bTABLE\\b", "\\bTHEN\\b", "\\bTO\\b", "\\bTOP\\b", "\\bTRANSACTION\\b", 
-        "\\bTRUNCATE\\b", "\\bUNION\\b", "\\bUNIQUE\\b", "\\bUPDATE\\b", "\\bUSING\\b", 
-        "\\bVALUES\\b", "\\bVIEW\\b", "\\bWHEN\\b", "\\bWHERE\\b", "\\bWITH\\b",
-        "\\bBEGIN\\b", "\\bCOMMIT\\b", "\\bREVOKE\\b", "\\bROLLBACK\\b", "\\bSAVEPOINT\\b"
+    static constexpr std::string_view keywords[] = {
+        "ADD", "ALL", "ALTER", "AND", "ANY", "AS", "ASC", "BACKUP", "BETWEEN", "BY",
+        "CASE", "CHECK", "CLUSTER", "COLUMN", "CONSTRAINT", "CREATE", "CROSS",
+        "CURRENT_DATE", "CURRENT_TIME", "CURRENT_TIMESTAMP", "CURRENT_USER",
+        "DATABASE", "DEFAULT", "DELETE", "DESC", "DISTINCT", "DROP", "EACH", "ELSE",
+        "END", "EXCEPT", "EXISTS", "FOREIGN", "FROM", "FULL", "GRANT", "GROUP",
+        "HAVING", "IN", "INDEX", "INNER", "INSERT", "INTERSECT", "INTO", "IS",
+        "JOIN", "KEY", "LEFT", "LIKE", "LIMIT", "NOT", "NULL", "OFFSET", "ON", "OR",
+        "ORDER", "OUTER", "PRIMARY", "PROCEDURE", "REFERENCES", "RIGHT", "ROLLBACK",
+        "ROW", "SELECT", "SET", "SOME", "TABLE", "THEN", "TO", "TOP", "TRANSACTION",
+        "TRUNCATE", "UNION", "UNIQUE", "UPDATE", "USING", "VALUES", "VIEW", "WHEN",
+        "WHERE", "WITH", "BEGIN", "COMMIT", "REVOKE", "ROLLBACK", "SAVEPOINT"
     };
+    static constexpr auto keywordTable = makeKeywordTable(keywords, CaseInsensitive);
     
     // SQL data types
-    const QStringList typePatterns = {
-        "\\bBIT\\b", "\\bTINYINT\\b", "\\bSMALLINT\\b", "\\bINT\\b", "\\bBIGINT\\b", 
-        "\\bDECIMAL\\b", "\\bNUMERIC\\b", "\\bFLOAT\\b", "\\bREAL\\b", "\\bDATETIME\\b", 
-        "\\bSMALLDATETIME\\b", "\\bCHAR\\b", "\\bVARCHAR\\b", "\\bTEXT\\b", "\\bNVARCHAR\\b", 
-        "\\bNTEXT\\b", "\\bBINARY\\b", "\\bVARBINARY\\b", "\\bIMAGE\\b", "\\bMONEY\\b", 
-        "\\bBOOLEAN\\b", "\\bBOOL\\b", "\\bDATE\\b", "\\bTIME\\b", "\\bTIMESTAMP\\b", 
-        "\\bINTERVAL\\b"
+    static constexpr std::string_view types[] = {
+        "BIT", "TINYINT", "SMALLINT", "INT", "BIGINT", "DECIMAL", "NUMERIC",
+        "FLOAT", "REAL", "DATETIME", "SMALLDATETIME", "CHAR", "VARCHAR", "TEXT",
+        "NVARCHAR", "NTEXT", "BINARY", "VARBINARY", "IMAGE", "MONEY", "BOOLEAN",
+        "BOOL", "DATE", "TIME", "TIMESTAMP", "INTERVAL"
     };
+    static constexpr auto typeTable = makeKeywordTable(types, CaseInsensitive);
     
     // SQL functions
-    const QStringList functionPatterns = {
-        "\\bABS\\b", "\\bAVG\\b", "\\bCOALESCE\\b", "\\bCONCAT\\b", "\\bCONVERT\\b", 
-        "\\bCOUNT\\b", "\\bCURRENT_DATE\\b", "\\bCURRENT_TIME\\b", "\\bDATE\\b", 
-        "\\bDATEDIFF\\b", "\\bDATEPART\\b", "\\bFORMAT\\b", "\\bLEN\\b", "\\bLOWER\\b", 
-        "\\bMAX\\b", "\\bMIN\\b", "\\bNOW\\b", "\\bROUND\\b", "\\bROW_NUMBER\\b", 
-        "\\bSUM\\b", "\\bSUBSTRING\\b", "\\bTRIM\\b", "\\bUPPER\\b"
+    static constexpr std::string_view functions[] = {
+        "ABS", "AVG", "COALESCE", "CONCAT", "CONVERT", "COUNT", "CURRENT_DATE",
+        "CURRENT_TIME", "DATE", "DATEDIFF", "DATEPART", "FORMAT", "LEN", "LOWER",
+        "MAX", "MIN", "NOW", "ROUND", "ROW_NUMBER", "SUM", "SUBSTRING", "TRIM",
+        "UPPER"
     };
+    static constexpr auto functionTable = makeKeywordTable(functions, CaseInsensitive);
     
     // Create rules for each keyword
-    for (const QString &pattern : keywordPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern, QRegularExpression::CaseInsensitiveOption);
-        rule.format = keywordFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(keywordTable, keywordFormat);
     
     // Create rules for data types
-    for (const QString &pattern : typePatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern, QRegularExpression::CaseInsensitiveOption);
-        rule.format = typeFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(typeTable, typeFormat);
     
     // Create rules for functions
-    for (const QString &pattern : functionPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern, QRegularExpression::CaseInsensitiveOption);
-        rule.format = functionFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(functionTable, functionFormat);
     
     // Operators
     HighlightingRule rule;
@@ -38,49 +38,35 @@ SwiftLanguage::SwiftLanguage()
     m_multiLineCommentFormat.setForeground(Qt::darkGreen);
     
     // Define Swift keywords
-    const QStringList keywordPatterns = {
-        "\\bas\\b", "\\bassociatedtype\\b", "\\bbreak\\b", "\\bcase\\b", "\\bcatch\\b",
-        "\\bclass\\b", "\\bcontinue\\b", "\\bdeinit\\b", "\\bdefault\\b", "\\bdefer\\b",
-        "\\bdo\\b", "\\belse\\b", "\\benum\\b", "\\bextension\\b", "\\bfallthrough\\b",
-        "\\bfalse\\b", "\\bfileprivate\\b", "\\bfor\\b", "\\bfunc\\b", "\\bguard\\b",
-        "\\bif\\b", "\\bin\\b", "\\binit\\b", "\\binout\\b", "\\bis\\b",
-        "\\binitializer\\b", "\\binternal\\b", "\\blet\\b", "\\bnil\\b", "\\boperator\\b",
-        "\\bprivate\\b", "\\bprotocol\\b", "\\bpublic\\b", "\\brepeat\\b", "\\brethrows\\b",
-        "\\breturn\\b", "\\bself\\b", "\\bSelf\\b", "\\bstatic\\b", "\\bstruct\\b",
-        "\\bsuper\\b", "\\bswitch\\b", "\\bthrow\\b", "\\bthrows\\b", "\\btrue\\b",
-        "\\btry\\b", "\\btypealias\\b", "\\bunderscore\\b", "\\bvar\\b", "\\bwhere\\b",
-        "\\bwhile\\b", "\\bany\\b", "\\bgame\\b", "\\bimport\\b", "\\bopen\\b",
-        "\\bset\\b", "\\bget\\b", "\\binfix\\b", "\\bpostfix\\b", "\\bprefix\\b",
-        "\\bpackage\\b", "\\brequired\\b", "\\bconvenience\\b", "\\bfinal\\b", "\\bmutating\\b",
-        "\\bnonmutating\\b", "\\boptional\\b", "\\bindirect\\b", "\\boverview\\b", "\\bAsync\\b",
-        "\\bawait\\b", "\\bactor\\b", "\\bdistributed\\b", "\\bisolated\\b", "\\bnonisolated\\b",
-        "\\bmacro\\b", "\\basync\\b"
+    static constexpr std::string_view keywords[] = {
+        "as", "associatedtype", "break", "case", "catch", "class", "continue",
+        "deinit", "default", "defer", "do", "else", "enum", "extension",
+        "fallthrough", "false", "fileprivate", "for", "func", "guard", "if", "in",
+        "init", "inout", "is", "initializer", "internal", "let", "nil", "operator",
+        "private", "protocol", "public", "repeat", "rethrows", "return", "self",
+        "Self", "static", "struct", "super", "switch", "throw", "throws", "true",
+        "try", "typealias", "underscore", "var", "where", "while", "any", "game",
+        "import", "open", "set", "get", "infix", "postfix", "prefix", "package",
+        "required", "convenience", "final", "mutating", "nonmutating", "optional",
+        "indirect", "overview", "Async", "await", "actor", "distributed",
+        "isolated", "nonisolated", "macro", "async"
     };
+    static constexpr auto keywordTable = makeKeywordTable(keywords);
     
     // Swift specially treated identifiers
-    const QStringList specialIdentifiers = {
-        "\\bBool\\b", "\\bCharacter\\b", "\\bDouble\\b", "\\bFloat\\b", "\\bInt\\b",
-        "\\bString\\b", "\\bUInt\\b", "\\bArray\\b", "\\bDictionary\\b", "\\bSet\\b",
-        "\\bResult\\b", "\\bError\\b", "\\bThrowable\\b", "\\bBundle\\b", "\\bData\\b",
-        "\\bURL\\b", "\\bOptional\\b", "\\bRange\\b", "\\bClosedRange\\b", "\\bSequence\\b",
-        "\\bCollection\\b", "\\bIterator\\b", "\\bBytes\\b", "\\bJSON\\b"
+    static constexpr std::string_view specialIdentifiers[] = {
+        "Bool", "Character", "Double", "Float", "Int", "String", "UInt", "Array",
+        "Dictionary", "Set", "Result", "Error", "Throwable", "Bundle", "Data",
+        "URL", "Optional", "Range", "ClosedRange", "Sequence", "Collection",
+        "Iterator", "Bytes", "JSON"
     };
+    static constexpr auto specialIdentifierTable = makeKeywordTable(specialIdentifiers);
     
     // Create rules for each keyword
-    for (const QString &pattern : keywordPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = keywordFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(keywordTable, keywordFormat);
     
     // Special identifiers
-    for (const QString &pattern : specialIdentifiers) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = specialFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(specialIdentifierTable, specialFormat);
     
     // Type names (starting with capital letter)
     HighlightingRule rule;
@@ -37,31 +37,22 @@ TypeScriptLanguage::TypeScriptLanguage()
     m_multiLineCommentFormat.setForeground(Qt::darkGreen);
     
     // Define TypeScript keywords
-    const QStringList keywordPatterns = {
-        "\\babstract\\b", "\\bas\\b", "\\basync\\b", "\\bawait\\b", "\\bboolean\\b",
-        "\\bbreak\\b", "\\bcase\\b", "\\bcatch\\b", "\\bclass\\b", "\\bconst\\b",
-        "\\bconstructor\\b", "\\bcontinue\\b", "\\bdebugger\\b", "\\bdeclare\\b", "\\bdefault\\b",
-        "\\bdelete\\b", "\\bdo\\b", "\\belse\\b", "\\benum\\b", "\\bexport\\b",
-        "\\bextends\\b", "\\bfalse\\b", "\\bfinally\\b", "\\bfor\\b", "\\bfrom\\b",
-        "\\bfunction\\b", "\\bget\\b", "\\bif\\b", "\\bimplements\\b", "\\bimport\\b",
-        "\\bin\\b", "\\binfer\\b", "\\binstanceof\\b", "\\binterface\\b", "\\bis\\b",
-        "\\bkeyof\\b", "\\blet\\b", "\\bmodule\\b", "\\bnamespace\\b", "\\bnew\\b",
-        "\\bnull\\b", "\\bnumber\\b", "\\bof\\b", "\\bpackage\\b", "\\bprivate\\b",
-        "\\bprotected\\b", "\\bpublic\\b", "\\breadonly\\b", "\\breturn\\b", "\\brequires\\b",
-        "\\bset\\b", "\\bstatic\\b", "\\bstring\\b", "\\bsuper\\b", "\\bswitch\\b",
-        "\\bsymbol\\b", "\\bthis\\b", "\\bthrow\\b", "\\btrue\\b", "\\btry\\b",
-        "\\btype\\b", "\\btypeof\\b", "\\bundefined\\b", "\\bunique\\b", "\\bunknown\\b",
-        "\\bvar\\b", "\\bvoid\\b", "\\bwhile\\b", "\\bwith\\b", "\\byield\\b",
-        "\\bany\\b", "\\bnever\\b", "\\bobject\\b", "\\baggregate\\b", "\\bconditional\\b"
+    static constexpr std::string_view keywords[] = {
+        "abstract", "as", "async", "await", "boolean", "break", "case", "catch",
+        "class", "const", "constructor", "continue", "debugger", "declare",
+        "default", "delete", "do", "else", "enum", "export", "extends", "false",
+        "finally", "for", "from", "function", "get", "if", "implements", "import",
+        "in", "infer", "instanceof", "interface", "is", "keyof", "let", "module",
+        "namespace", "new", "null", "number", "of", "package", "private",
+        "protected", "public", "readonly", "return", "requires", "set", "static",
+        "string", "super", "switch", "symbol", "this", "throw", "true", "try",
+        "type", "typeof", "undefined", "unique", "unknown", "var", "void", "while",
+        "with", "yield", "any", "never", "object", "aggregate", "conditional"
     };
+    static constexpr auto keywordTable = makeKeywordTable(keywords);
     
     // Create rules for each keyword
-    for (const QString &pattern : keywordPatterns) {
-        HighlightingRule rule;
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = keywordFormat;
-        m_highlightingRules.append(rule);
-    }
+    addKeywords(keywordTable, keywordFormat);
     
     // Type annotations
     HighlightingRule rule;
@@ -0,0 +1,336 @@
+#include "lexer.h"
+#include <algorithm>
+#include <climits>
+#include "charclass.h"
+
+// Block states: the region index plus one in the low byte, the nesting
+// depth in the next, the delimiter id above
+static const int RegionBits = 0xff;
+static const int DepthShift = 8;
+static const int DelimiterShift = 16;
+
+Lexer::Lexer()
+    : m_ruleSet(new RuleSet), m_engine(ScannerEngine)
+{
+}
+
+Lexer::Lexer(const QSharedPointer<const RuleSet> &ruleSet)
+    : m_ruleSet(ruleSet), m_engine(ScannerEngine)
+{
+    if (!m_ruleSet->rules().isEmpty())
+        m_cache = TokenCache::forLanguage(m_ruleSet->name(), m_engine);
+}
+
+void Lexer::setEngine(Engine engine)
+{
+    if (m_engine == engine)
+        return;
+    m_engine = engine;
+    if (m_cache)
+        m_cache = TokenCache::forLanguage(m_ruleSet->name(), m_engine);
+}
+
+int Lexer::lex(const QString &text, int previousState, QVector<TokenRun> *runs) const
+{
+    runs->clear();
+    int state;
+    if (!text.isEmpty() && m_cache && m_cache->find(text, previousState, runs, &state))
+        return state;
+
+    if (m_engine == OverlayEngine)
+        state = lexOverlay(text, previousState, runs);
+    else
+        state = lexScanner(text, previousState, runs);
+
+    if (!text.isEmpty() && m_cache)
+        m_cache->insert(text, previousState, *runs, state);
+    return state;
+}
+
+int Lexer::lexOverlay(const QString &text, int previousState, QVector<TokenRun> *runs) const
+{
+    const QVector<RuleSet::Rule> &rules = m_ruleSet->rules();
+    const QVector<RuleSet::Region> &regions = m_ruleSet->regions();
+
+    // Rules are applied in order and later matches win; the styles are
+    // collected per character and then merged
+    QVector<int> styles(text.length(), -1);
+    for (const RuleSet::Rule &rule : rules) {
+        if (!rule.keywords.isEmpty()) {
+            for (Match match = nextKeyword(rule, text, 0); match.start >= 0;
+                 match = nextKeyword(rule, text, match.end))
+                std::fill(styles.begin() + match.start, styles.begin() + match.end, match.style);
+            continue;
+        }
+        QRegularExpressionMatchIterator matchIterator = rule.pattern.globalMatch(text);
+        while (matchIterator.hasNext()) {
+            QRegularExpressionMatch match = matchIterator.next();
+            std::fill(styles.begin() + match.capturedStart(), styles.begin() + match.capturedEnd(), rule.style);
+        }
+    }
+
+    // Regions paint over the rules, each searched for after the last
+    int state = regions.isEmpty() ? -1 : 0;
+    int pending = 0;
+    int pos = 0;
+    const int length = text.length();
+    if (previousState > 0 && (previousState & RegionBits) <= regions.size()) {
+        int region = (previousState & RegionBits) - 1;
+        int depth = (previousState >> DepthShift) & RegionBits;
+        int delimiter = previousState >> DelimiterShift;
+        int end = regionEnd(text, 0, region, delimiter, &depth);
+        if (end < 0) {
+            end = length;
+            state = regionState(region, depth, delimiter);
+        }
+        std::fill(styles.begin(), styles.begin() + end, regions.at(region).style);
+        pos = end;
+    }
+
+    while (state == 0 && pos < length) {
+        RegionMatch match = nextRegion(text, pos);
+        if (match.start < 0)
+            break;
+        const RuleSet::Region &region = regions.at(match.region);
+        int depth = 1;
+        int end = match.end;
+        if (region.bodyOnNextLine) {
+            pending = regionState(match.region, 0, match.delimiter);
+        } else {
+            end = regionEnd(text, match.end, match.region, match.delimiter, &depth);
+            if (end < 0) {
+                end = length;
+                state = regionState(match.region, depth, match.delimiter);
+            }
+        }
+        std::fill(styles.begin() + match.start, styles.begin() + end, region.style);
+        pos = end;
+    }
+    if (state == 0)
+        state = pending;
+
+    for (int i = 0; i < styles.size(); ) {
+        int end = i + 1;
+        while (end < styles.size() && styles.at(end) == styles.at(i))
+            ++end;
+        if (styles.at(i) >= 0)
+            appendRun(runs, i, end, styles.at(i));
+        i = end;
+    }
+    return state;
+}
+
+int Lexer::lexScanner(const QString &text, int previousState, QVector<TokenRun> *runs) const
+{
+    const QVector<RuleSet::Rule> &rules = m_ruleSet->rules();
+    const QVector<RuleSet::Region> &regions = m_ruleSet->regions();
+    const int length = text.length();
+    int state = regions.isEmpty() ? -1 : 0;
+    int pending = 0;
+    int pos = 0;
+
+    // Finishes a region from its start: up to and including the end
+    // marker, or to the end of the block if it stays open
+    auto consumeRegion = [&](int start, int searchFrom, int region, int depth, int delimiter) {
+        int end = regionEnd(text, searchFrom, region, delimiter, &depth);
+        if (end < 0) {
+            end = length;
+            state = regionState(region, depth, delimiter);
+        }
+        appendRun(runs, start, end, regions.at(region).style);
+        pos = end;
+    };
+
+    if (previousState > 0 && (previousState & RegionBits) <= regions.size()) {
+        consumeRegion(0, 0, (previousState & RegionBits) - 1,
+                      (previousState >> DepthShift) & RegionBits, previousState >> DelimiterShift);
+    }
+
+    // Every rule's next match is kept until the scan moves past its start,
+    // so each rule searches the block about once per token it produces
+    QVector<Match> next(rules.size());
+    for (Match &match : next)
+        match.start = -2;
+    RegionMatch region;
+    region.start = -2;
+
+    while (state <= 0 && pos < length) {
+        int best = -1;
+        int bestStart = INT_MAX;
+        int bestEnd = 0;
+        for (int i = 0; i < rules.size(); ++i) {
+            Match &match = next[i];
+            if (match.start == -2 || (match.start >= 0 && match.start < pos))
+                match = nextMatch(rules.at(i), text, pos);
+            if (match.start < 0)
+                continue;
+            // Ties go to the longer match, then to the later rule
+            if (match.start < bestStart || (match.start == bestStart && match.end >= bestEnd)) {
+                best = i;
+                bestStart = match.start;
+                bestEnd = match.end;
+            }
+        }
+
+        if (!regions.isEmpty()) {
+            if (region.start == -2 || (region.start >= 0 && region.start < pos))
+                region = nextRegion(text, pos);
+            // A region starting where a token does takes precedence, as
+            // the comment pass always painted over the rules
+            if (region.start >= 0 && region.start <= bestStart) {
+                if (regions.at(region.region).bodyOnNextLine) {
+                    // Only the marker here; the rest of the line is code
+                    appendRun(runs, region.start, region.end, regions.at(region.region).style);
+                    pending = regionState(region.region, 0, region.delimiter);
+                    pos = region.end;
+                } else {
+                    consumeRegion(region.start, region.end, region.region, 1, region.delimiter);
+                }
+                continue;
+            }
+        }
+
+        if (best < 0)
+            break;
+        appendRun(runs, bestStart, bestEnd, next.at(best).style);
+        pos = bestEnd;
+    }
+    if (state == 0)
+        state = pending;
+    return state;
+}
+
+Lexer::RegionMatch Lexer::nextRegion(const QString &text, int from) const
+{
+    const QVector<RuleSet::Region> &regions = m_ruleSet->regions();
+
+    // The earliest start wins, then the region declared first
+    RegionMatch result;
+    result.start = -1;
+    for (int i = 0; i < regions.size(); ++i) {
+        const RuleSet::Region &region = regions.at(i);
+        QRegularExpressionMatch match = region.start.match(text, from);
+        while (match.hasMatch() && region.startAllowed
+               && !region.startAllowed(text, match.capturedStart()))
+            match = region.start.match(text, match.capturedStart() + 1);
+        if (!match.hasMatch() || match.capturedLength() == 0)
+            continue;
+        if (result.start >= 0 && match.capturedStart() >= result.start)
+            continue;
+        result.start = match.capturedStart();
+        result.end = match.capturedEnd();
+        result.region = i;
+        result.delimiter = 0;
+        if (!region.endPattern.isEmpty())
+            result.delimiter = RuleSet::delimiterId(match.captured(QStringLiteral("delimiter")));
+    }
+    return result;
+}
+
+int Lexer::regionEnd(const QString &text, int from, int region, int delimiter, int *depth) const
+{
+    const RuleSet::Region &r = m_ruleSet->regions().at(region);
+    const QRegularExpression end = r.endPattern.isEmpty() ? r.end : m_ruleSet->delimitedEnd(region, delimiter);
+    if (*depth < 1)
+        *depth = 1;
+
+    while (from <= text.length()) {
+        QRegularExpressionMatch endMatch = end.match(text, from);
+        if (!endMatch.hasMatch() || endMatch.capturedLength() == 0)
+            return -1;
+        if (r.nested) {
+            // An inner start before the end opens one more level
+            QRegularExpressionMatch startMatch = r.start.match(text, from);
+            if (startMatch.hasMatch() && startMatch.capturedLength() > 0
+                && startMatch.capturedStart() < endMatch.capturedStart()) {
+                *depth = qMin(*depth + 1, RegionBits);
+                from = startMatch.capturedEnd();
+                continue;
+            }
+            if (--*depth > 0) {
+                from = endMatch.capturedEnd();
+                continue;
+            }
+        }
+        return endMatch.capturedEnd();
+    }
+    return -1;
+}
+
+int Lexer::regionState(int region, int depth, int delimiter)
+{
+    // Plain regions keep depth 0, so an open C comment is still state 1
+    if (depth == 1)
+        depth = 0;
+    return (region + 1) | (depth << DepthShift) | (delimiter << DelimiterShift);
+}
+
+Lexer::Match Lexer::nextMatch(const RuleSet::Rule &rule, const QString &text, int from) const
+{
+    if (!rule.keywords.isEmpty())
+        return nextKeyword(rule, text, from);
+
+    Match result;
+    result.start = -1;
+    // Empty matches would not consume anything; look past them
+    while (from <= text.length()) {
+        QRegularExpressionMatch match = rule.pattern.match(text, from);
+        if (!match.hasMatch())
+            break;
+        if (match.capturedLength() > 0) {
+            result.start = match.capturedStart();
+            result.end = match.capturedEnd();
+            result.style = rule.style;
+            break;
+        }
+        from = match.capturedStart() + 1;
+    }
+    return result;
+}
+
+Lexer::Match Lexer::nextKeyword(const RuleSet::Rule &rule, const QString &text, int from) const
+{
+    Match result;
+    result.start = -1;
+    const auto *chars = text.utf16();
+    const int length = text.length();
+
+    // A keyword can only start on a word boundary
+    int i = from;
+    while (i > 0 && i < length && CharClass::isWord(chars[i - 1]) && CharClass::isWord(chars[i]))
+        ++i;
+
+    while (i < length) {
+        if (!CharClass::isWord(chars[i])) {
+            ++i;
+            continue;
+        }
+        int start = i;
+        while (i < length && CharClass::isWord(chars[i]))
+            ++i;
+        for (int table = rule.keywords.size() - 1; table >= 0; --table) {
+            if (rule.keywords.at(table).contains(chars + start, i - start)) {
+                result.start = start;
+                result.end = i;
+                result.style = rule.keywordStyles.at(table);
+                return result;
+            }
+        }
+    }
+    return result;
+}
+
+void Lexer::appendRun(QVector<TokenRun> *runs, int start, int end, int style)
+{
+    if (end <= start)
+        return;
+    if (!runs->isEmpty() && runs->last().style == style && runs->last().start + runs->last().length == start) {
+        runs->last().length += end - start;
+        return;
+    }
+    TokenRun run;
+    run.start = start;
+    run.length = end - start;
+    run.style = style;
+    runs->append(run);
+}
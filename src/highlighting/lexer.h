@@ -0,0 +1,86 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <QRegularExpression>
+#include <QTextCharFormat>
+#include <QVector>
+#include <QSharedPointer>
+#include "ruleset.h"
+#include "tokendata.h"
+#include "tokencache.h"
+
+// Turns one block of text into token runs for a language. The rules come
+// from the language's RuleSet, which copies of a lexer share.
+//
+// Two engines are available so they can be compared on real files:
+// - OverlayEngine runs every rule over the whole block in order and lets
+//   later matches paint over earlier ones, which is what the highlighter
+//   has always done.
+// - ScannerEngine makes one pass from left to right. At each position the
+//   rule matching first wins, then the longest match, then the rule
+//   declared last; the text it covers is consumed, so tokens never
+//   overlap and a comment marker inside a string stays part of the string.
+//
+// Comments, triple-quoted and raw strings and heredocs that run over
+// several blocks are block regions. The state a block ends in is -1 for a
+// language without any, 0 when none is open, and otherwise packs the open
+// region, its nesting depth and the delimiter it must be closed with.
+//
+// Keyword lists are looked up in their compile-time tables during a scan
+// over the identifiers of the block, instead of one regex per word.
+//
+// Lines lexed before, with the same entry state, are answered from the
+// token cache of the language.
+//
+// A lexer is not changed once built, copies share the rule set, and lex()
+// may be called from any thread.
+class Lexer
+{
+public:
+    enum Engine {
+        OverlayEngine,
+        ScannerEngine
+    };
+
+    Lexer();
+    explicit Lexer(const QSharedPointer<const RuleSet> &ruleSet);
+
+    Engine engine() const { return m_engine; }
+    void setEngine(Engine engine);
+
+    QSharedPointer<const RuleSet> ruleSet() const { return m_ruleSet; }
+
+    // Returns the state the block ends in, to be passed in for the next
+    int lex(const QString &text, int previousState, QVector<TokenRun> *runs) const;
+
+private:
+    // The next match of a rule at or after a position; start is -1 if none
+    struct Match {
+        int start;
+        int end;
+        int style;
+    };
+
+    // The earliest region start at or after a position; start is -1 if none
+    struct RegionMatch {
+        int start;
+        int end;
+        int region;
+        int delimiter;
+    };
+
+    RegionMatch nextRegion(const QString &text, int from) const;
+    int regionEnd(const QString &text, int from, int region, int delimiter, int *depth) const;
+    static int regionState(int region, int depth, int delimiter);
+    int lexOverlay(const QString &text, int previousState, QVector<TokenRun> *runs) const;
+    int lexScanner(const QString &text, int previousState, QVector<TokenRun> *runs) const;
+    Match nextMatch(const RuleSet::Rule &rule, const QString &text, int from) const;
+    Match nextKeyword(const RuleSet::Rule &rule, const QString &text, int from) const;
+    static void appendRun(QVector<TokenRun> *runs, int start, int end, int style);
+
+    QSharedPointer<const RuleSet> m_ruleSet;
+    Engine m_engine;
+    QSharedPointer<TokenCache> m_cache;  // none for plain text
+};
+
+#endif // LEXER_H
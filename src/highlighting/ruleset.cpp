@@ -0,0 +1,132 @@
+#include "ruleset.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+
+// Guards the delimiter table and the compiled ends of every rule set,
+// which the tokenizer threads reach through shared rule sets
+static QMutex delimiterMutex;
+static QStringList delimiterTexts = { QString() };
+static QHash<QString, int> delimiterIds;
+
+RuleSet::RuleSet()
+    : m_name("Plain Text")
+{
+}
+
+RuleSet::RuleSet(const LanguageData &langData)
+    : m_name(langData.name())
+{
+    for (const auto &rule : langData.highlightingRules()) {
+        if (!rule.keywords.isNull()) {
+            if (m_rules.isEmpty() || m_rules.last().keywords.isEmpty()) {
+                Rule newRule;
+                newRule.style = -1;
+                m_rules.append(newRule);
+            }
+            m_rules.last().keywords.append(rule.keywords);
+            m_rules.last().keywordStyles.append(addStyle(rule.format));
+            continue;
+        }
+        Rule newRule;
+        newRule.pattern = rule.pattern;
+        newRule.pattern.optimize();
+        newRule.style = addStyle(rule.format);
+        m_rules.append(newRule);
+    }
+
+    for (const BlockRegion &blockRegion : langData.blockRegions()) {
+        if (m_regions.size() == MaxRegions)
+            break;
+        Region region;
+        region.start = blockRegion.start;
+        region.start.optimize();
+        region.end = blockRegion.end;
+        region.end.optimize();
+        region.endPattern = blockRegion.endPattern;
+        region.style = addStyle(blockRegion.format);
+        region.nested = blockRegion.nested;
+        region.bodyOnNextLine = blockRegion.bodyOnNextLine;
+        region.startAllowed = blockRegion.startAllowed;
+        m_regions.append(region);
+    }
+
+    for (const QTextCharFormat &format : qAsConst(m_formats))
+        m_darkFormats.append(darkThemeFormat(format));
+}
+
+QRegularExpression RuleSet::delimitedEnd(int region, int delimiter) const
+{
+    const int key = delimiter << 8 | region;
+    QMutexLocker locker(&delimiterMutex);
+    auto it = m_delimitedEnds.constFind(key);
+    if (it != m_delimitedEnds.constEnd())
+        return it.value();
+
+    const QString &text = delimiterTexts.at(qBound(0, delimiter, delimiterTexts.size() - 1));
+    QRegularExpression end(m_regions.at(region).endPattern.arg(QRegularExpression::escape(text)));
+    end.optimize();
+    m_delimitedEnds.insert(key, end);
+    return end;
+}
+
+int RuleSet::delimiterId(const QString &delimiter)
+{
+    if (delimiter.isEmpty())
+        return 0;
+    QMutexLocker locker(&delimiterMutex);
+    int id = delimiterIds.value(delimiter);
+    if (id == 0 && delimiterTexts.size() <= MaxDelimiters) {
+        id = delimiterTexts.size();
+        delimiterTexts.append(delimiter);
+        delimiterIds.insert(delimiter, id);
+    }
+    return id;
+}
+
+int RuleSet::addStyle(const QTextCharFormat &format)
+{
+    int style = m_formats.indexOf(format);
+    if (style < 0) {
+        style = m_formats.size();
+        m_formats.append(format);
+    }
+    return style;
+}
+
+QTextCharFormat RuleSet::darkThemeFormat(const QTextCharFormat &format)
+{
+    // Create dark theme version of the format with much more vibrant colors
+    QTextCharFormat darkFormat = format; // Start with the same format
+    
+    // Adjust colors for dark theme - use significantly more vibrant colors
+    QColor color = format.foreground().color();
+    
+    if (color == Qt::darkBlue) 
+        darkFormat.setForeground(QColor(100, 180, 255));    // Much brighter blue for keywords
+    else if (color == Qt::blue)
+        darkFormat.setForeground(QColor(100, 180, 255));    // Bright blue for keywords
+    else if (color == Qt::darkRed) 
+        darkFormat.setForeground(QColor(235, 160, 120));   // Much brighter orange for strings
+    else if (color == Qt::darkGreen) 
+        darkFormat.setForeground(QColor(120, 180, 100));   // Significantly brighter green for comments
+    else if (color == Qt::darkYellow) 
+        darkFormat.setForeground(QColor(248, 248, 170));   // Much brighter yellow
+    else if (color == Qt::darkMagenta) 
+        darkFormat.setForeground(QColor(227, 154, 235));   // Vibrant purple for keywords/tags
+    else if (color == Qt::darkCyan) 
+        darkFormat.setForeground(QColor(98, 240, 220));    // Bright teal for identifiers
+    else if (color == Qt::black) 
+        darkFormat.setForeground(QColor(240, 240, 240));   // Almost white text for better contrast
+    else if (color == QColor(0, 128, 128)) // Typical teal color
+        darkFormat.setForeground(QColor(98, 240, 220));    // Brighter teal
+    else if (color == QColor(128, 0, 128)) // Typical purple
+        darkFormat.setForeground(QColor(227, 154, 235));   // Much brighter purple
+    else if (color == QColor(128, 64, 0)) // Brown
+        darkFormat.setForeground(QColor(235, 160, 100));   // Brighter brown
+    // Special case for any remaining dark colors that might be hard to see
+    else if (color.lightness() < 128)
+        darkFormat.setForeground(QColor(240, 240, 240));   // Ensure all text is visible
+    
+    return darkFormat;
+}
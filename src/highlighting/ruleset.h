@@ -0,0 +1,80 @@
+#ifndef RULESET_H
+#define RULESET_H
+
+#include <QRegularExpression>
+#include <QHash>
+#include <QString>
+#include <QTextCharFormat>
+#include <QVector>
+#include "languagedata.h"
+#include "keywordtable.h"
+
+// A language compiled for the lexer: its rules and block regions with
+// every regex optimized up front, or for ends that depend on a delimiter,
+// once that delimiter is seen, and the formats by style index for the
+// light and the dark theme. A rule set is never changed once built, so the
+// factory makes one per language and every highlighter and tokenizer of
+// that language shares it.
+class RuleSet
+{
+public:
+    struct Rule {
+        QRegularExpression pattern;
+        int style;
+        // Keyword lists declared one after another are scanned for together;
+        // a word in several of them gets the style of the last
+        QVector<KeywordTable> keywords;
+        QVector<int> keywordStyles;
+    };
+
+    struct Region {
+        QRegularExpression start;
+        QRegularExpression end;
+        QString endPattern;
+        int style;
+        bool nested;
+        bool bodyOnNextLine;
+        bool (*startAllowed)(const QString &text, int start);
+    };
+
+    RuleSet();
+    explicit RuleSet(const LanguageData &langData);
+
+    QString name() const { return m_name; }
+    const QVector<Rule> &rules() const { return m_rules; }
+    const QVector<Region> &regions() const { return m_regions; }
+
+    // Formats by style index, as the language declares them or as
+    // brightened for the dark theme
+    const QVector<QTextCharFormat> &formats(bool darkTheme = false) const
+    {
+        return darkTheme ? m_darkFormats : m_formats;
+    }
+
+    // End of a region whose end depends on the delimiter it was opened
+    // with, compiled the first time that delimiter closes it
+    QRegularExpression delimitedEnd(int region, int delimiter) const;
+
+    // Delimiters of open raw strings and heredocs have to survive in an int
+    // block state, so each one seen gets a small id for the life of the
+    // process. Id 0 is the empty delimiter, and is also what any delimiter
+    // gets once the table is full.
+    static int delimiterId(const QString &delimiter);
+
+    // A region index has to fit in the low byte of a block state
+    static const int MaxRegions = 0xff;
+    static const int MaxDelimiters = 0x7fff;
+
+private:
+    int addStyle(const QTextCharFormat &format);
+    static QTextCharFormat darkThemeFormat(const QTextCharFormat &format);
+
+    QString m_name;
+    QVector<Rule> m_rules;
+    QVector<Region> m_regions;
+    QVector<QTextCharFormat> m_formats;
+    QVector<QTextCharFormat> m_darkFormats;
+    mutable QHash<int, QRegularExpression> m_delimitedEnds;  // by delimiter << 8 | region
+};
+
+#endif // RULESET_H
@@ -1,22 +1,70 @@
 #include "syntaxhighlighter.h"
 #include "languagedata.h"
+#include <QTextBlock>
+#include <climits>
 
 SyntaxHighlighter::SyntaxHighlighter(QTextDocument *parent)
-    : QSyntaxHighlighter(parent), m_languageName("Plain Text"), m_darkTheme(false)
+    : QSyntaxHighlighter(parent), m_darkTheme(false),
+      m_paletteGeneration(0), m_recoloring(false), m_firstVisibleBlock(-1), m_lastVisibleBlock(-1)
 {
     // Default constructor - no language rules
+    init();
+    setupRuleSet(QSharedPointer<const RuleSet>(new RuleSet));
 }
 
 SyntaxHighlighter::SyntaxHighlighter(const LanguageData &langData, QTextDocument *parent)
-    : QSyntaxHighlighter(parent), m_darkTheme(false)
+    : QSyntaxHighlighter(parent), m_darkTheme(false),
+      m_paletteGeneration(0), m_recoloring(false), m_firstVisibleBlock(-1), m_lastVisibleBlock(-1)
 {
-    setupFormatsForLanguage(langData);
+    init();
+    setupRuleSet(QSharedPointer<const RuleSet>(new RuleSet(langData)));
+}
+
+SyntaxHighlighter::SyntaxHighlighter(const QSharedPointer<const RuleSet> &ruleSet, QTextDocument *parent)
+    : QSyntaxHighlighter(parent), m_darkTheme(false),
+      m_paletteGeneration(0), m_recoloring(false), m_firstVisibleBlock(-1), m_lastVisibleBlock(-1)
+{
+    init();
+    setupRuleSet(ruleSet);
+}
+
+void SyntaxHighlighter::init()
+{
+    m_tokenizer = new Tokenizer(this);
+    m_tokenizing = false;
+    m_dirtyFrom = INT_MAX;
+    m_dirtyTo = -1;
+    m_changedFrom = INT_MAX;
+    m_changedTo = -1;
+    m_shiftedFrom = INT_MAX;
+    m_blockCount = document() ? document()->blockCount() : 0;
+    m_speculativeJob = false;
+
+    m_tokenizeTimer.setSingleShot(true);
+    connect(&m_tokenizeTimer, &QTimer::timeout, this, &SyntaxHighlighter::startTokenizer);
+    connect(m_tokenizer, &QThread::finished, this, &SyntaxHighlighter::applyTokens);
+    if (document())
+        connect(document(), &QTextDocument::contentsChange, this, &SyntaxHighlighter::documentChanged);
+}
+
+void SyntaxHighlighter::relexAll()
+{
+    // Whatever the tokenizer is working on was lexed with the old rules
+    m_changedFrom = 0;
+    m_changedTo = INT_MAX;
+    m_checkpoints.clear();
+    rehighlight();
 }
 
 void SyntaxHighlighter::setLanguageData(const LanguageData &langData)
 {
-    setupFormatsForLanguage(langData);
-    rehighlight(); // Force redraw with new rules
+    setRuleSet(QSharedPointer<const RuleSet>(new RuleSet(langData)));
+}
+
+void SyntaxHighlighter::setRuleSet(const QSharedPointer<const RuleSet> &ruleSet)
+{
+    setupRuleSet(ruleSet);
+    relexAll(); // Force redraw with new rules
 }
 
 void SyntaxHighlighter::setDarkTheme(bool useDarkTheme)
@@ -24,121 +72,305 @@ void SyntaxHighlighter::setDarkTheme(bool useDarkTheme)
     if (m_darkTheme == useDarkTheme)
         return;
         
+    // The tokens stay valid; only the palette changes. Every block is now
+    // stale, but only the ones on screen are recolored right away.
     m_darkTheme = useDarkTheme;
-    updateFormatsForTheme();
-    rehighlight(); // Force redraw with new theme colors
-}
-
-void SyntaxHighlighter::setupFormatsForLanguage(const LanguageData &langData)
-{
-    // Clear any existing rules
-    highlightingRules.clear();
-    
-    // Save the language name
-    m_languageName = langData.name();
-    
-    // Copy all highlighting rules from the language data
-    for (const auto &rule : langData.highlightingRules()) {
-        HighlightingRule newRule;
-        newRule.pattern = rule.pattern;
-        newRule.format = rule.format;
-        
-        // Create dark theme version of the format with much more vibrant colors
-        newRule.darkThemeFormat = rule.format; // Start with the same format
-        
-        // Adjust colors for dark theme - use significantly more vibrant colors
-        QColor color = rule.format.foreground().color();
-        
-        if (color == Qt::darkBlue) 
-            newRule.darkThemeFormat.setForeground(QColor(100, 180, 255));    // Much brighter blue for keywords
-        else if (color == Qt::blue)
-            newRule.darkThemeFormat.setForeground(QColor(100, 180, 255));    // Bright blue for keywords
-        else if (color == Qt::darkRed) 
-            newRule.darkThemeFormat.setForeground(QColor(235, 160, 120));   // Much brighter orange for strings
-        else if (color == Qt::darkGreen) 
-            newRule.darkThemeFormat.setForeground(QColor(120, 180, 100));   // Significantly brighter green for comments
-        else if (color == Qt::darkYellow) 
-            newRule.darkThemeFormat.setForeground(QColor(248, 248, 170));   // Much brighter yellow
-        else if (color == Qt::darkMagenta) 
-            newRule.darkThemeFormat.setForeground(QColor(227, 154, 235));   // Vibrant purple for keywords/tags
-        else if (color == Qt::darkCyan) 
-            newRule.darkThemeFormat.setForeground(QColor(98, 240, 220));    // Bright teal for identifiers
-        else if (color == Qt::black) 
-            newRule.darkThemeFormat.setForeground(QColor(240, 240, 240));   // Almost white text for better contrast
-        else if (color == QColor(0, 128, 128)) // Typical teal color
-            newRule.darkThemeFormat.setForeground(QColor(98, 240, 220));    // Brighter teal
-        else if (color == QColor(128, 0, 128)) // Typical purple
-            newRule.darkThemeFormat.setForeground(QColor(227, 154, 235));   // Much brighter purple
-        else if (color == QColor(128, 64, 0)) // Brown
-            newRule.darkThemeFormat.setForeground(QColor(235, 160, 100));   // Brighter brown
-        // Special case for any remaining dark colors that might be hard to see
-        else if (color.lightness() < 128)
-            newRule.darkThemeFormat.setForeground(QColor(240, 240, 240));   // Ensure all text is visible
-        
-        highlightingRules.append(newRule);
-    }
-    
-    // Set up multi-line comment handling
-    commentStartExpression = langData.commentStartExpression();
-    commentEndExpression = langData.commentEndExpression();
-    multiLineCommentFormat = langData.multiLineCommentFormat();
-    
-    // Create dark theme version of multi-line comment format
-    multiLineCommentDarkFormat = langData.multiLineCommentFormat();
-    if (multiLineCommentFormat.foreground().color() == Qt::darkGreen) {
-        multiLineCommentDarkFormat.setForeground(QColor(120, 180, 100)); // Much brighter green for comments
+    ++m_paletteGeneration;
+    recolorVisibleBlocks();
+}
+
+void SyntaxHighlighter::setEngine(Lexer::Engine engine)
+{
+    if (m_lexer.engine() == engine)
+        return;
+
+    m_lexer.setEngine(engine);
+    relexAll();
+}
+
+void SyntaxHighlighter::setVisibleBlocks(int first, int last)
+{
+    m_firstVisibleBlock = first;
+    m_lastVisibleBlock = last;
+    recolorVisibleBlocks();
+
+    // Scrolling to blocks the tokenizer has not reached moves them ahead
+    if (last + ViewportMargin >= m_dirtyFrom && !m_tokenizeTimer.isActive())
+        m_tokenizeTimer.start(0);
+}
+
+void SyntaxHighlighter::recolorVisibleBlocks()
+{
+    QTextDocument *doc = document();
+    if (!doc || m_firstVisibleBlock < 0 || m_recoloring)
+        return;
+
+    // rehighlightBlock() calls back into highlightBlock(), which only
+    // reapplies the stored runs while this is set
+    m_recoloring = true;
+    QTextBlock block = doc->findBlockByNumber(m_firstVisibleBlock);
+    for (int number = m_firstVisibleBlock; block.isValid() && number <= m_lastVisibleBlock; ++number) {
+        TokenData *data = static_cast<TokenData *>(block.userData());
+        if (data && data->paletteGeneration != m_paletteGeneration)
+            rehighlightBlock(block);
+        block = block.next();
     }
+    m_recoloring = false;
 }
 
-void SyntaxHighlighter::updateFormatsForTheme()
+void SyntaxHighlighter::setupRuleSet(const QSharedPointer<const RuleSet> &ruleSet)
 {
-    // This method would adjust format rules based on theme
-    // But we're now handling this directly in the highlightBlock method
-    // by using the appropriate format for the active theme
+    // Nothing is compiled here; the rule set already was
+    m_ruleSet = ruleSet;
+    Lexer::Engine engine = m_lexer.engine();
+    m_lexer = Lexer(ruleSet);
+    m_lexer.setEngine(engine);
+    ++m_paletteGeneration;
 }
 
 void SyntaxHighlighter::highlightBlock(const QString &text)
 {
-    // Apply syntax highlighting rules
-    foreach (const HighlightingRule &rule, highlightingRules) {
-        QRegularExpressionMatchIterator matchIterator = rule.pattern.globalMatch(text);
-        while (matchIterator.hasNext()) {
-            QRegularExpressionMatch match = matchIterator.next();
-            
-            // Use the appropriate format based on the theme
-            QTextCharFormat format = m_darkTheme ? rule.darkThemeFormat : rule.format;
-            setFormat(match.capturedStart(), match.capturedLength(), format);
+    TokenData *data = static_cast<TokenData *>(currentBlockUserData());
+    if (m_recoloring) {
+        // Only the colors changed: the text and the block state did not, so
+        // the stored runs are still right
+        if (data) {
+            applyRuns(data->runs);
+            data->paletteGeneration = m_paletteGeneration;
         }
+        return;
     }
-    
-    // Handle multi-line comments if the language supports them
-    if (!commentStartExpression.pattern().isEmpty() && commentStartExpression.isValid() && commentEndExpression.isValid()) {
-        setCurrentBlockState(0);
-        
-        int startIndex = 0;
-        if (previousBlockState() != 1)
-            startIndex = text.indexOf(commentStartExpression);
-            
-        while (startIndex >= 0) {
-            QRegularExpressionMatch match = commentEndExpression.match(text, startIndex);
-            int endIndex = match.capturedStart();
-            int commentLength = 0;
-            
-            if (endIndex == -1) {
-                setCurrentBlockState(1);
-                commentLength = text.length() - startIndex;
-            } else {
-                commentLength = endIndex - startIndex + match.capturedLength();
-            }
-            
-            // Use the appropriate comment format based on the theme
-            if (m_darkTheme) {
-                setFormat(startIndex, commentLength, multiLineCommentDarkFormat);
-            } else {
-                setFormat(startIndex, commentLength, multiLineCommentFormat);
+
+    const int number = currentBlock().blockNumber();
+    if (!isNearViewport(number)) {
+        // Left to the tokenizer; the block stays plain until then
+        if (data)
+            setCurrentBlockUserData(nullptr);
+        markDirty(number, number);
+        return;
+    }
+
+    const bool lexedBefore = data != nullptr;
+    if (!data) {
+        data = new TokenData;
+        setCurrentBlockUserData(data);
+    }
+    int state = m_lexer.lex(text, previousBlockState(), &data->runs);
+    applyRuns(data->runs);
+    data->paletteGeneration = m_paletteGeneration;
+
+    if (lexedBefore && state != currentBlockState())
+        markDirty(number, number + 1);
+    else
+        setCurrentBlockState(state);
+    data->speculative = number >= m_dirtyFrom;
+}
+
+bool SyntaxHighlighter::isNearViewport(int blockNumber) const
+{
+    // Before the view reports its blocks, assume it shows the top
+    int first = qMax(m_firstVisibleBlock, 0);
+    int last = qMax(m_lastVisibleBlock, 0);
+    return blockNumber >= first - ViewportMargin && blockNumber <= last + ViewportMargin;
+}
+
+void SyntaxHighlighter::markDirty(int first, int last)
+{
+    m_dirtyFrom = qMin(m_dirtyFrom, first);
+    m_dirtyTo = qMax(m_dirtyTo, last);
+    if (!m_tokenizeTimer.isActive())
+        m_tokenizeTimer.start(0);
+}
+
+void SyntaxHighlighter::documentChanged(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved);
+
+    // Recoloring only touches formats
+    if (m_recoloring)
+        return;
+
+    // Blocks after the edited ones move by as many blocks as were added or
+    // removed; ranges that reach into removed blocks end at the edit
+    int block = document()->findBlock(position).blockNumber();
+    int last = document()->findBlock(position + charsAdded).blockNumber();
+    int added = document()->blockCount() - m_blockCount;
+    m_blockCount = document()->blockCount();
+    auto shift = [&](int number) {
+        return number > block ? qMax(number + added, block) : number;
+    };
+
+    if (added != 0) {
+        if (m_dirtyFrom != INT_MAX)
+            m_dirtyFrom = shift(m_dirtyFrom);
+        if (m_dirtyTo >= block)
+            m_dirtyTo = qMax(m_dirtyTo + added, block);
+        if (m_changedTo != INT_MAX)
+            m_changedTo = shift(m_changedTo);
+        m_shiftedFrom = qMin(m_shiftedFrom, block);
+    }
+    m_changedFrom = qMin(m_changedFrom, block);
+    m_changedTo = qMax(m_changedTo, last);
+
+    // Checkpoints below the edit move with their blocks
+    if (added != 0 && !m_checkpoints.isEmpty() && m_checkpoints.lastKey() > block) {
+        QMap<int, int> moved;
+        for (auto it = m_checkpoints.constBegin(); it != m_checkpoints.constEnd(); ++it) {
+            if (it.key() <= block)
+                moved.insert(it.key(), it.value());
+            else if (it.key() + added > block)
+                moved.insert(it.key() + added, it.value());
+        }
+        m_checkpoints = moved;
+    }
+}
+
+bool SyntaxHighlighter::viewNeedsLexing(int first, int last) const
+{
+    QTextBlock block = document()->findBlockByNumber(first);
+    for (int number = first; block.isValid() && number <= last; ++number) {
+        if (!block.userData())
+            return true;
+        block = block.next();
+    }
+    return false;
+}
+
+void SyntaxHighlighter::startTokenizer()
+{
+    // The chunk in flight reschedules when it comes back
+    QTextDocument *doc = document();
+    if (!doc || m_tokenizing || m_dirtyFrom == INT_MAX)
+        return;
+
+    int first = m_dirtyFrom;
+    int count = ChunkBlocks;
+    int entryState = -1;
+    bool useBlockState = true;
+    m_speculativeJob = false;
+
+    // A view further down than the next chunk reaches is lexed on its own,
+    // from the nearest checkpoint in front of it
+    int viewFirst = qMax(m_firstVisibleBlock - ViewportMargin, 0);
+    int viewLast = m_lastVisibleBlock + ViewportMargin;
+    if (m_firstVisibleBlock >= 0 && viewFirst > m_dirtyFrom + ChunkBlocks
+        && viewNeedsLexing(viewFirst, viewLast)) {
+        first = viewFirst;
+        useBlockState = false;
+        const QMap<int, int> &checkpoints = m_checkpoints;
+        QMap<int, int>::const_iterator checkpoint = checkpoints.upperBound(viewFirst - 1);
+        if (checkpoint != checkpoints.constBegin()) {
+            --checkpoint;
+            // One in front of the sweep is exact and one past it may be
+            // stale; either beats a guess, and the job stays speculative
+            if (checkpoint.key() >= viewFirst - CheckpointInterval) {
+                first = checkpoint.key() + 1;
+                entryState = checkpoint.value();
             }
-            
-            startIndex = text.indexOf(commentStartExpression, startIndex + commentLength);
         }
+        count = viewLast - first + 1;
+        m_speculativeJob = true;
+    }
+
+    QTextBlock block = doc->findBlockByNumber(first);
+    if (!block.isValid()) {
+        m_dirtyFrom = INT_MAX;
+        m_dirtyTo = -1;
+        return;
+    }
+
+    if (useBlockState && block.previous().isValid())
+        entryState = block.previous().userState();
+
+    // A frontier chunk stops at the first block past the dirty range that
+    // ends as it did before; blocks lexed from a guessed entry state, or
+    // not at all, do not count
+    QStringList texts;
+    QVector<int> previousStates;
+    for (int i = 0; i < count && block.isValid(); ++i) {
+        texts.append(block.text());
+        if (!m_speculativeJob) {
+            const TokenData *data = static_cast<const TokenData *>(block.userData());
+            const bool known = data && !data->speculative && first + i >= m_dirtyTo;
+            previousStates.append(known ? block.userState() : INT_MIN);
+        }
+        block = block.next();
+    }
+    m_changedFrom = INT_MAX;
+    m_changedTo = -1;
+    m_shiftedFrom = INT_MAX;
+    m_tokenizing = true;
+    m_tokenizer->tokenize(m_lexer, first, entryState, texts, previousStates);
+}
+
+void SyntaxHighlighter::applyTokens()
+{
+    QTextDocument *doc = document();
+    const QVector<QVector<TokenRun>> &runs = m_tokenizer->runs();
+    const QVector<int> &states = m_tokenizer->states();
+    const int first = m_tokenizer->firstBlock();
+    const int end = first + runs.size();
+    m_tokenizing = false;
+
+    // A chunk whose blocks changed or moved meanwhile is lexed again. An
+    // edit in front of it that kept the block count marked its own block
+    // dirty, and the sweep from there corrects the chunk if it has to.
+    const bool changed = m_changedFrom < end && m_changedTo >= first;
+    const bool moved = m_shiftedFrom < first;
+    if (!doc || !m_tokenizer->isCompleted() || changed || moved) {
+        if (doc && !m_speculativeJob)
+            markDirty(first, first);
+        else if (m_dirtyFrom != INT_MAX)
+            m_tokenizeTimer.start(0);
+        return;
     }
+
+    // Runs and states go straight into the blocks; formats are only made
+    // for the blocks on screen, the rest when they scroll into view
+    QTextBlock block = doc->findBlockByNumber(first);
+    for (int i = 0; i < runs.size() && block.isValid(); ++i) {
+        TokenData *data = static_cast<TokenData *>(block.userData());
+        const bool lexedBefore = data != nullptr;
+        if (!data) {
+            data = new TokenData;
+            block.setUserData(data);
+        }
+        if (!lexedBefore || data->runs != runs.at(i)) {
+            data->runs = runs.at(i);
+            data->paletteGeneration = -1;
+        }
+        data->speculative = m_speculativeJob;
+        block.setUserState(states.at(i));
+        if (!m_speculativeJob && (first + i + 1) % CheckpointInterval == 0)
+            m_checkpoints.insert(first + i, states.at(i));
+        block = block.next();
+    }
+
+    if (m_speculativeJob) {
+        if (m_dirtyFrom != INT_MAX)
+            m_tokenizeTimer.start(0);
+        recolorVisibleBlocks();
+        return;
+    }
+
+    // Once a block ends in the state it already had, and no block further
+    // down is waiting, everything after it is up to date. Blocks marked
+    // dirty while the chunk was out are still lexed.
+    if (m_dirtyFrom < first) {
+        m_tokenizeTimer.start(0);
+    } else if (!block.isValid() || (m_tokenizer->isSettled() && m_dirtyTo < end)) {
+        m_dirtyFrom = INT_MAX;
+        m_dirtyTo = -1;
+    } else {
+        m_dirtyFrom = end;
+        m_tokenizeTimer.start(0);
+    }
+    recolorVisibleBlocks();
+}
+
+void SyntaxHighlighter::applyRuns(const QVector<TokenRun> &runs)
+{
+    const QVector<QTextCharFormat> &palette = m_ruleSet->formats(m_darkTheme);
+    for (const TokenRun &run : runs)
+        setFormat(run.start, run.length, palette.at(run.style));
 }
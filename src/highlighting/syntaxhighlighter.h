@@ -5,8 +5,33 @@
 #include <QTextDocument>
 #include <QRegularExpression>
 #include <QVector>
+#include <QTimer>
+#include <QMap>
 #include "languagedata.h" // Include the full header instead of forward declaration
+#include "lexer.h"
+#include "tokenizer.h"
 
+// Lexing and coloring are kept apart: a block is lexed into runs of style
+// indexes, which are kept with the block, and the runs are turned into
+// formats through the palette of the current theme. Both palettes come
+// with the language's rule set, shared by every tab of that language.
+// Switching themes swaps the palette and recolors the blocks on screen
+// from their stored runs; the others are recolored when they scroll into
+// view.
+//
+// Only blocks near the viewport are lexed on the GUI thread, one at a time
+// as they change. Everything else is lexed by a Tokenizer thread in chunks
+// of blocks and shows as plain text until its runs arrive. A block that
+// was lexed before keeps its old end state when it is edited, so an edit
+// never ripples through the rest of the document on the GUI thread; the
+// tokenizer carries the new state on from there, and stops at the first
+// block that ends in the state it ended in before.
+//
+// The tokenizer normally works down from the first dirty block. When the
+// view shows blocks it has not reached yet, those are lexed first, starting
+// from the nearest checkpoint (the end state of every thousandth block as
+// last lexed) or, without one, from the view itself. Such blocks are only
+// speculative until the sweep from the top confirms them.
 class SyntaxHighlighter : public QSyntaxHighlighter
 {
     Q_OBJECT
@@ -14,38 +39,68 @@ class SyntaxHighlighter : public QSyntaxHighlighter
 public:
     SyntaxHighlighter(QTextDocument *parent = nullptr);
     SyntaxHighlighter(const LanguageData &langData, QTextDocument *parent = nullptr);
+    SyntaxHighlighter(const QSharedPointer<const RuleSet> &ruleSet, QTextDocument *parent = nullptr);
     
     void setLanguageData(const LanguageData &langData);
-    QString languageName() const { return m_languageName; }
+    void setRuleSet(const QSharedPointer<const RuleSet> &ruleSet);
+    QString languageName() const { return m_ruleSet->name(); }
     void setDarkTheme(bool useDarkTheme);
+
+    // Which lexer engine tokenizes the blocks; switching rehighlights
+    Lexer::Engine engine() const { return m_lexer.engine(); }
+    void setEngine(Lexer::Engine engine);
+
+    // The blocks the view shows; stale ones among them are recolored
+    void setVisibleBlocks(int first, int last);
     
 protected:
     void highlightBlock(const QString &text) override;
+
+private slots:
+    void documentChanged(int position, int charsRemoved, int charsAdded);
+    void startTokenizer();
+    void applyTokens();
     
 private:
-    struct HighlightingRule {
-        QRegularExpression pattern;
-        QTextCharFormat format;
-        QTextCharFormat darkThemeFormat; // Dark theme version
-    };
-    QVector<HighlightingRule> highlightingRules;
-    
-    QRegularExpression commentStartExpression;
-    QRegularExpression commentEndExpression;
-    
-    QTextCharFormat keywordFormat;
-    QTextCharFormat classFormat;
-    QTextCharFormat singleLineCommentFormat;
-    QTextCharFormat multiLineCommentFormat;
-    QTextCharFormat multiLineCommentDarkFormat; // Dark theme version
-    QTextCharFormat quotationFormat;
-    QTextCharFormat functionFormat;
+    Lexer m_lexer;
+    Tokenizer *m_tokenizer;
+    bool m_tokenizing;
+    QTimer m_tokenizeTimer;
+
+    // Blocks still to be lexed by the tokenizer; the blocks edited since the
+    // current chunk was handed to it, and the first block at which blocks
+    // were added or removed meanwhile
+    int m_dirtyFrom;
+    int m_dirtyTo;
+    int m_changedFrom;
+    int m_changedTo;
+    int m_shiftedFrom;
+    int m_blockCount;
+    bool m_speculativeJob;
+    QMap<int, int> m_checkpoints;  // block number -> end state
+
+    // The compiled language, shared with the lexer; its palettes map
+    // TokenRun::style to a format for either theme
+    QSharedPointer<const RuleSet> m_ruleSet;
     
-    QString m_languageName;
     bool m_darkTheme;
+    int m_paletteGeneration;
+    bool m_recoloring;
+    int m_firstVisibleBlock;
+    int m_lastVisibleBlock;
     
-    void setupFormatsForLanguage(const LanguageData &langData);
-    void updateFormatsForTheme();
+    void setupRuleSet(const QSharedPointer<const RuleSet> &ruleSet);
+    void init();
+    void relexAll();
+    bool isNearViewport(int blockNumber) const;
+    void markDirty(int first, int last);
+    bool viewNeedsLexing(int first, int last) const;
+    void applyRuns(const QVector<TokenRun> &runs);
+    void recolorVisibleBlocks();
+
+    static const int ChunkBlocks = 2000;
+    static const int ViewportMargin = 100;
+    static const int CheckpointInterval = 1000;
 };
 
 #endif // SYNTAXHIGHLIGHTER_H
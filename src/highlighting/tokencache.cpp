@@ -0,0 +1,48 @@
+#include "tokencache.h"
+#include <QHash>
+#include <QMutexLocker>
+#include <QWeakPointer>
+
+TokenCache::TokenCache()
+    : m_entries(MaxCost)
+{
+}
+
+QSharedPointer<TokenCache> TokenCache::forLanguage(const QString &language, int engine)
+{
+    static QMutex mutex;
+    static QHash<QString, QWeakPointer<TokenCache>> caches;
+
+    QMutexLocker locker(&mutex);
+    const QString key = language + QLatin1Char('/') + QString::number(engine);
+    QSharedPointer<TokenCache> cache = caches.value(key).toStrongRef();
+    if (!cache) {
+        cache.reset(new TokenCache);
+        caches.insert(key, cache);
+    }
+    return cache;
+}
+
+bool TokenCache::find(const QString &text, int entryState, QVector<TokenRun> *runs, int *exitState)
+{
+    QMutexLocker locker(&m_mutex);
+    const Entry *entry = m_entries.object(Key(entryState, text));
+    if (!entry)
+        return false;
+    *runs = entry->runs;
+    *exitState = entry->exitState;
+    return true;
+}
+
+void TokenCache::insert(const QString &text, int entryState, const QVector<TokenRun> &runs, int exitState)
+{
+    // Cost is roughly what the entry keeps alive: the text and the runs
+    int cost = text.size() * static_cast<int>(sizeof(QChar))
+             + runs.size() * static_cast<int>(sizeof(TokenRun)) + 64;
+    Entry *entry = new Entry;
+    entry->runs = runs;
+    entry->exitState = exitState;
+
+    QMutexLocker locker(&m_mutex);
+    m_entries.insert(Key(entryState, text), entry, cost);
+}
@@ -0,0 +1,43 @@
+#ifndef TOKENCACHE_H
+#define TOKENCACHE_H
+
+#include <QCache>
+#include <QMutex>
+#include <QPair>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+#include "tokendata.h"
+
+// Remembers what lexing a line produced: the runs and the end state for a
+// given text and entry state. Undo, redo, pasting the same text again or
+// reopening a file then costs a hash lookup per line instead of running
+// the rules. Least recently used lines are dropped once the cache holds
+// more than MaxCost bytes.
+//
+// One cache is shared by every lexer of the same language and engine, on
+// any thread, and lives as long as one of them does.
+class TokenCache
+{
+public:
+    static QSharedPointer<TokenCache> forLanguage(const QString &language, int engine);
+
+    bool find(const QString &text, int entryState, QVector<TokenRun> *runs, int *exitState);
+    void insert(const QString &text, int entryState, const QVector<TokenRun> &runs, int exitState);
+
+private:
+    struct Entry {
+        QVector<TokenRun> runs;
+        int exitState;
+    };
+    typedef QPair<int, QString> Key;
+
+    TokenCache();
+
+    QMutex m_mutex;
+    QCache<Key, Entry> m_entries;
+
+    static const int MaxCost = 4 * 1024 * 1024;
+};
+
+#endif // TOKENCACHE_H
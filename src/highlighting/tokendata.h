@@ -0,0 +1,35 @@
+#ifndef TOKENDATA_H
+#define TOKENDATA_H
+
+#include <QTextBlockUserData>
+#include <QVector>
+
+// A stretch of a block drawn in one style; the style is an index into the
+// highlighter's palette, not a format, so it survives a theme change
+struct TokenRun {
+    int start;
+    int length;
+    int style;
+};
+
+inline bool operator==(const TokenRun &a, const TokenRun &b)
+{
+    return a.start == b.start && a.length == b.length && a.style == b.style;
+}
+
+// The runs found when a block was last lexed. The palette generation says
+// which palette the block's formats were made from, so blocks whose colors
+// are stale can be found without lexing them again. A speculative block
+// was lexed from a guessed or outdated entry state and is checked again
+// when lexing from the top reaches it.
+class TokenData : public QTextBlockUserData
+{
+public:
+    TokenData() : paletteGeneration(-1), speculative(false) {}
+
+    QVector<TokenRun> runs;
+    int paletteGeneration;
+    bool speculative;
+};
+
+#endif // TOKENDATA_H
@@ -0,0 +1,54 @@
+#include "tokenizer.h"
+
+Tokenizer::Tokenizer(QObject *parent)
+    : QThread(parent), m_firstBlock(0), m_entryState(-1), m_completed(false), m_settled(false)
+{
+}
+
+Tokenizer::~Tokenizer()
+{
+    cancel();
+    wait();
+}
+
+void Tokenizer::tokenize(const Lexer &lexer, int firstBlock, int entryState, const QStringList &texts,
+                         const QVector<int> &previousStates)
+{
+    m_lexer = lexer;
+    m_firstBlock = firstBlock;
+    m_entryState = entryState;
+    m_texts = texts;
+    m_previousStates = previousStates;
+    m_completed = false;
+    m_settled = false;
+    start();
+}
+
+void Tokenizer::cancel()
+{
+    requestInterruption();
+}
+
+void Tokenizer::run()
+{
+    m_runs.clear();
+    m_states.clear();
+    m_runs.reserve(m_texts.size());
+    m_states.reserve(m_texts.size());
+
+    int state = m_entryState;
+    for (int i = 0; i < m_texts.size(); ++i) {
+        if (isInterruptionRequested())
+            return;
+        QVector<TokenRun> runs;
+        state = m_lexer.lex(m_texts.at(i), state, &runs);
+        m_runs.append(runs);
+        m_states.append(state);
+        if (i < m_previousStates.size() && state == m_previousStates.at(i)) {
+            m_settled = true;
+            break;
+        }
+    }
+    m_texts.clear();
+    m_completed = true;
+}
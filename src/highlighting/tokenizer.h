@@ -0,0 +1,53 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <QThread>
+#include <QStringList>
+#include <QVector>
+#include "lexer.h"
+
+// Lexes a run of consecutive blocks on a worker thread. The highlighter
+// hands it a copy of the block texts and the state the block before them
+// ended in, and picks the runs and exit states up once the thread has
+// finished; the document itself is never touched from here.
+//
+// Given the states the blocks ended in before, it stops at the first block
+// that ends in the same state again: everything after it is unchanged.
+class Tokenizer : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit Tokenizer(QObject *parent = nullptr);
+    ~Tokenizer();
+
+    // previousStates holds INT_MIN for blocks whose old state is unknown or
+    // may not be relied on, and may be shorter than texts
+    void tokenize(const Lexer &lexer, int firstBlock, int entryState, const QStringList &texts,
+                  const QVector<int> &previousStates = QVector<int>());
+    void cancel();
+
+    // Valid once the thread has finished, if it was not cancelled
+    bool isCompleted() const { return m_completed; }
+    bool isSettled() const { return m_settled; }
+    int firstBlock() const { return m_firstBlock; }
+    const QVector<QVector<TokenRun>> &runs() const { return m_runs; }
+    const QVector<int> &states() const { return m_states; }
+
+protected:
+    void run() override;
+
+private:
+    Lexer m_lexer;
+    int m_firstBlock;
+    int m_entryState;
+    QStringList m_texts;
+    QVector<int> m_previousStates;
+
+    QVector<QVector<TokenRun>> m_runs;
+    QVector<int> m_states;
+    bool m_completed;
+    bool m_settled;
+};
+
+#endif // TOKENIZER_H
@@ -0,0 +1,624 @@
+#include "largefileview.h"
+#include "codeeditor.h"
+#include <QScrollBar>
+#include <QTimer>
+#include <QKeyEvent>
+#include <QWheelEvent>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QStringList>
+#include <algorithm>
+
+LargeFileView::LargeFileView(CodeEditor *editor, QScrollBar *scrollBar, QObject *parent)
+    : QObject(parent), m_editor(editor), m_scrollBar(scrollBar),
+      m_encoding(EncodingDetector::Utf8), m_lineEnding(LineEndingScanner::platformDefault()),
+      m_mixedLineEndings(false), m_topOffset(0),
+      m_updating(false), m_settlePending(false)
+{
+    // The editor only ever holds one screen of text, so its own scrollbar is
+    // meaningless and its undo stack would only know about that screen
+    m_editor->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    m_editor->setUndoRedoEnabled(false);
+
+    m_scrollBar->setRange(0, ScrollBarSteps);
+    connect(m_scrollBar, &QScrollBar::valueChanged, this, &LargeFileView::scrollBarMoved);
+
+    // The font size decides how many lines fit on screen
+    connect(m_editor, &CodeEditor::zoomLevelChanged, this, [this](int) {
+        refresh();
+    });
+
+    connect(m_editor->document(), &QTextDocument::contentsChange, this, &LargeFileView::documentChanged);
+
+    m_editor->installEventFilter(this);
+    m_editor->viewport()->installEventFilter(this);
+
+    m_indexTimer = new QTimer(this);
+    m_indexTimer->setInterval(0);
+    connect(m_indexTimer, &QTimer::timeout, this, &LargeFileView::indexNextChunk);
+}
+
+LargeFileView::~LargeFileView()
+{
+    m_indexTimer->stop();
+    m_buffer.close();
+}
+
+bool LargeFileView::open(const QString &fileName)
+{
+    if (!m_buffer.open(fileName)) {
+        m_errorString = m_buffer.errorString();
+        return false;
+    }
+
+    // Only the terminators matter here, so any byte-wise decoding will do
+    QByteArray sample = m_buffer.text(0, LineEndingSample);
+    if (sample.endsWith('\r') && sample.size() < m_buffer.size())
+        sample.chop(1);
+    QString sampleText = QString::fromLatin1(sample);
+    LineEndingScanner lineEndings;
+    lineEndings.scan(sampleText);
+    m_lineEnding = lineEndings.dominantStyle();
+    m_mixedLineEndings = lineEndings.isMixed();
+
+    m_topOffset = 0;
+    m_indexTimer->start();
+
+    refresh();
+    return true;
+}
+
+bool LargeFileView::reopen(const QString &fileName)
+{
+    // After a save the mapping still refers to the file that was replaced.
+    // Map the saved file instead; offsets stay the same but the undo history restarts.
+    qint64 top = m_topOffset;
+    if (!open(fileName))
+        return false;
+    scrollToOffset(top);
+    return true;
+}
+
+void LargeFileView::releaseFile()
+{
+    m_indexTimer->stop();
+    m_buffer.releaseOriginal();
+}
+
+bool LargeFileView::restoreFile()
+{
+    if (!m_buffer.remapOriginal()) {
+        m_errorString = m_buffer.errorString();
+        return false;
+    }
+    m_indexTimer->start();
+    refresh();
+    updateScrollBar();
+    return true;
+}
+
+void LargeFileView::undo()
+{
+    if (!m_buffer.isOpen())
+        return;
+
+    bool wasModified = m_buffer.isModified();
+    qint64 offset = m_buffer.undo();
+    if (offset < 0)
+        return;
+
+    showOffset(offset);
+    if (wasModified != m_buffer.isModified())
+        emit modificationChanged(m_buffer.isModified());
+}
+
+void LargeFileView::redo()
+{
+    if (!m_buffer.isOpen())
+        return;
+
+    bool wasModified = m_buffer.isModified();
+    qint64 offset = m_buffer.redo();
+    if (offset < 0)
+        return;
+
+    showOffset(offset);
+    if (wasModified != m_buffer.isModified())
+        emit modificationChanged(m_buffer.isModified());
+}
+
+void LargeFileView::setEncoding(EncodingDetector::Encoding encoding)
+{
+    m_encoding = encoding;
+    m_editor->setReadOnly(encoding == EncodingDetector::Binary);
+}
+
+QString LargeFileView::decode(const QByteArray &bytes, QVector<int> *offsets) const
+{
+    offsets->clear();
+    bool ascii = std::all_of(bytes.constBegin(), bytes.constEnd(), [](char c) { return static_cast<uchar>(c) < 0x80; });
+    if (ascii || m_encoding == EncodingDetector::Latin1 || m_encoding == EncodingDetector::Binary)
+        return QString::fromLatin1(bytes);
+
+    // Decodes UTF-8 by hand so every character knows the bytes it came
+    // from; each byte of an invalid sequence becomes one U+FFFD
+    QString text;
+    text.reserve(bytes.size());
+    offsets->reserve(bytes.size());
+    const uchar *data = reinterpret_cast<const uchar *>(bytes.constData());
+    const int size = bytes.size();
+    for (int i = 0; i < size; ) {
+        uint c = data[i];
+        int length = 1;
+        uint low = 0x80, high = 0xbf;
+        if (c >= 0xc2 && c <= 0xdf) {
+            length = 2;
+            c &= 0x1f;
+        } else if (c >= 0xe0 && c <= 0xef) {
+            length = 3;
+            c &= 0x0f;
+            if (c == 0x0)
+                low = 0xa0;     // overlong
+            else if (c == 0xd)
+                high = 0x9f;    // surrogates
+        } else if (c >= 0xf0 && c <= 0xf4) {
+            length = 4;
+            c &= 0x07;
+            if (c == 0x0)
+                low = 0x90;     // overlong
+            else if (c == 0x4)
+                high = 0x8f;    // past U+10FFFF
+        } else if (c >= 0x80) {
+            length = 0;
+        }
+
+        int n = 1;
+        for (; n < length && i + n < size; ++n) {
+            uint next = data[i + n];
+            if (next < low || next > high)
+                break;
+            c = (c << 6) | (next & 0x3f);
+            low = 0x80;
+            high = 0xbf;
+        }
+        if (length == 0 || n < length) {
+            text.append(QChar(QChar::ReplacementCharacter));
+            offsets->append(i);
+            ++i;
+            continue;
+        }
+
+        if (c > 0xffff) {
+            text.append(QChar(QChar::highSurrogate(c)));
+            text.append(QChar(QChar::lowSurrogate(c)));
+            offsets->append(i);
+        } else {
+            text.append(QChar(static_cast<ushort>(c)));
+        }
+        offsets->append(i);
+        i += length;
+    }
+    return text;
+}
+
+QByteArray LargeFileView::encode(const QString &text) const
+{
+    if (m_encoding == EncodingDetector::Latin1 || m_encoding == EncodingDetector::Binary)
+        return text.toLatin1();
+    return text.toUtf8();
+}
+
+int LargeFileView::visibleLineCount() const
+{
+    int lineHeight = qMax(1, m_editor->fontMetrics().lineSpacing());
+    return qMax(1, m_editor->viewport()->height() / lineHeight + 1);
+}
+
+void LargeFileView::scrollToOffset(qint64 offset)
+{
+    if (!m_buffer.isOpen())
+        return;
+
+    // Don't scroll past the point where the last line sits at the bottom
+    qint64 lastTop = m_buffer.lineStart(m_buffer.size() - 1, MaxLineBytes);
+    for (int i = 0; i < visibleLineCount() - 2 && lastTop > 0; ++i)
+        lastTop = m_buffer.previousLineStart(lastTop, MaxLineBytes);
+
+    offset = qBound<qint64>(0, offset, lastTop);
+    m_topOffset = m_buffer.lineStart(offset, MaxLineBytes);
+
+    refresh();
+    updateScrollBar();
+}
+
+void LargeFileView::scrollLines(int delta)
+{
+    if (!m_buffer.isOpen())
+        return;
+
+    qint64 pos = m_topOffset;
+    if (delta > 0) {
+        for (int i = 0; i < delta; ++i) {
+            qint64 next = nextBlockStart(pos);
+            if (next >= m_buffer.size())
+                break;
+            pos = next;
+        }
+    } else {
+        for (int i = 0; i > delta && pos > 0; --i)
+            pos = m_buffer.previousLineStart(pos, MaxLineBytes);
+    }
+
+    if (pos != m_topOffset)
+        scrollToOffset(pos);
+}
+
+LargeFileView::WindowBlock LargeFileView::blockAt(qint64 pos, QByteArray *bytes) const
+{
+    WindowBlock block;
+    block.start = pos;
+    block.terminator = 0;
+    block.position = 0;
+
+    qint64 next = m_buffer.nextLineStart(pos, MaxLineBytes);
+    QByteArray data = m_buffer.text(pos, next - pos);
+    int end = data.size();
+    if (data.endsWith('\n')) {
+        --end;
+        block.terminator = 1;
+        if (end > 0 && data.at(end - 1) == '\r') {
+            --end;
+            block.terminator = 2;
+        }
+    } else if (next < m_buffer.size()) {
+        // Cut by the length limit: a CR goes with the LF after it, and a
+        // UTF-8 sequence is not split between two blocks
+        if (data.endsWith('\r') && m_buffer.text(next, 1) == "\n") {
+            --end;
+            block.terminator = 2;
+        } else if (m_encoding == EncodingDetector::Utf8) {
+            int lead = end - 1;
+            while (lead > 0 && end - lead < 4 && (static_cast<uchar>(data.at(lead)) & 0xc0) == 0x80)
+                --lead;
+            uchar c = static_cast<uchar>(data.at(lead));
+            int length = c >= 0xf0 ? 4 : c >= 0xe0 ? 3 : c >= 0xc0 ? 2 : 1;
+            if (lead > 0 && lead + length > end)
+                end = lead;
+        }
+    }
+
+    // A CR not followed by LF ends the block too; the editor would split
+    // the block there anyway
+    int cr = data.indexOf('\r');
+    if (cr >= 0 && cr < end) {
+        end = cr;
+        block.terminator = 1;
+    }
+
+    block.length = end;
+    *bytes = data.left(end);
+    return block;
+}
+
+qint64 LargeFileView::nextBlockStart(qint64 pos) const
+{
+    QByteArray bytes;
+    WindowBlock block = blockAt(pos, &bytes);
+    return block.start + block.length + block.terminator;
+}
+
+QString LargeFileView::layoutWindow(int maxBlocks)
+{
+    // Every block break in the text is a '\n', and every block records the
+    // bytes it stands for, so positions and offsets map both ways exactly
+    QString text;
+    qint64 pos = m_topOffset;
+    m_windowBlocks.clear();
+    while (m_windowBlocks.size() < maxBlocks && pos < m_buffer.size()) {
+        QByteArray bytes;
+        WindowBlock block = blockAt(pos, &bytes);
+        if (!m_windowBlocks.isEmpty())
+            text.append(QLatin1Char('\n'));
+        block.position = text.size();
+        text.append(decode(bytes, &block.offsets));
+        m_windowBlocks.append(block);
+        pos = block.start + block.length + block.terminator;
+    }
+
+    // A terminator at the very end of the file starts one more, empty line
+    if (m_windowBlocks.size() < maxBlocks
+        && (m_windowBlocks.isEmpty() || m_windowBlocks.last().terminator > 0)) {
+        WindowBlock block;
+        block.start = pos;
+        block.length = 0;
+        block.terminator = 0;
+        if (!m_windowBlocks.isEmpty())
+            text.append(QLatin1Char('\n'));
+        block.position = text.size();
+        m_windowBlocks.append(block);
+    }
+    return text;
+}
+
+void LargeFileView::refresh()
+{
+    if (!m_buffer.isOpen())
+        return;
+
+    // Keep the cursor on the same screen row across page changes
+    QTextCursor oldCursor = m_editor->textCursor();
+    int cursorRow = oldCursor.blockNumber();
+    int cursorColumn = oldCursor.positionInBlock();
+    int horizontalScroll = m_editor->horizontalScrollBar()->value();
+
+    // Collect just enough lines to fill the viewport
+    m_updating = true;
+    m_windowText = layoutWindow(visibleLineCount() + 1);
+    m_editor->setPlainText(m_windowText);
+    m_editor->document()->setModified(false);
+
+    QTextBlock block = m_editor->document()->findBlockByNumber(
+        qMin(cursorRow, m_editor->document()->blockCount() - 1));
+    QTextCursor cursor(block);
+    cursor.setPosition(block.position() + qMin(cursorColumn, block.length() - 1));
+    m_editor->setTextCursor(cursor);
+    m_editor->horizontalScrollBar()->setValue(horizontalScroll);
+    m_updating = false;
+
+    updateLineNumbers();
+}
+
+void LargeFileView::rebuildWindowLines()
+{
+    // The editor already shows the edited text; only the mapping is redone
+    layoutWindow(m_editor->document()->blockCount());
+}
+
+qint64 LargeFileView::byteOffsetAt(int position) const
+{
+    position = qBound(0, position, m_windowText.size());
+    auto after = std::upper_bound(m_windowBlocks.constBegin(), m_windowBlocks.constEnd(), position,
+                                  [](int pos, const WindowBlock &block) { return pos < block.position; });
+    const WindowBlock &block = *(after == m_windowBlocks.constBegin() ? after : after - 1);
+
+    // Past the text of the block means its terminator, i.e. its end
+    int column = position - block.position;
+    int chars = (after != m_windowBlocks.constEnd() ? after->position - 1 : m_windowText.size()) - block.position;
+    if (column >= chars)
+        return block.start + block.length;
+    if (block.offsets.isEmpty())
+        return block.start + column;
+    return block.start + block.offsets.at(column);
+}
+
+int LargeFileView::positionAt(qint64 offset) const
+{
+    auto after = std::upper_bound(m_windowBlocks.constBegin(), m_windowBlocks.constEnd(), offset,
+                                  [](qint64 pos, const WindowBlock &block) { return pos < block.start; });
+    if (after == m_windowBlocks.constBegin())
+        return 0;
+    const WindowBlock &block = *(after - 1);
+
+    int column = static_cast<int>(qMin<qint64>(offset - block.start, block.length));
+    if (!block.offsets.isEmpty()) {
+        column = static_cast<int>(std::lower_bound(block.offsets.constBegin(), block.offsets.constEnd(), column)
+                                  - block.offsets.constBegin());
+    }
+    return block.position + column;
+}
+
+void LargeFileView::documentChanged(int position, int charsRemoved, int charsAdded)
+{
+    if (m_updating || m_windowBlocks.isEmpty() || !m_buffer.isOpen())
+        return;
+
+    QStringList blocks;
+    for (QTextBlock block = m_editor->document()->begin(); block.isValid(); block = block.next())
+        blocks.append(block.text());
+    QString newText = blocks.join(QLatin1Char('\n'));
+
+    // QTextDocument can report a wider range than what changed, so trim it
+    // down to the characters that actually differ from the old window
+    int oldEnd = qMin(position + charsRemoved, m_windowText.size());
+    int newEnd = qMin(position + charsAdded, newText.size());
+    while (position < oldEnd && position < newEnd && m_windowText.at(position) == newText.at(position))
+        ++position;
+    while (oldEnd > position && newEnd > position && m_windowText.at(oldEnd - 1) == newText.at(newEnd - 1)) {
+        --oldEnd;
+        --newEnd;
+    }
+
+    qint64 from = byteOffsetAt(position);
+    qint64 to = byteOffsetAt(oldEnd);
+    QString added = newText.mid(position, newEnd - position);
+    added.replace(QLatin1Char('\n'), LineEndingScanner::sequence(m_lineEnding));
+    QByteArray inserted = encode(added);
+    m_windowText = newText;
+    if (from == to && inserted.isEmpty())
+        return;
+
+    bool wasModified = m_buffer.isModified();
+    bool replacing = to > from && !inserted.isEmpty();
+    if (replacing)
+        m_buffer.beginGroup();
+    m_buffer.remove(from, to - from);
+    m_buffer.insert(from, inserted);
+    if (replacing)
+        m_buffer.endGroup();
+
+    rebuildWindowLines();
+    updateLineNumbers();
+
+    // Re-render once the editor has finished processing the edit
+    if (!m_settlePending) {
+        m_settlePending = true;
+        QTimer::singleShot(0, this, &LargeFileView::settleAfterEdit);
+    }
+
+    if (wasModified != m_buffer.isModified())
+        emit modificationChanged(m_buffer.isModified());
+}
+
+void LargeFileView::settleAfterEdit()
+{
+    m_settlePending = false;
+    if (!m_buffer.isOpen())
+        return;
+
+    // Scroll when an edit pushed the cursor below the last visible row
+    QTextCursor cursor = m_editor->textCursor();
+    int overflow = cursor.blockNumber() - (visibleLineCount() - 2);
+    if (overflow > 0) {
+        // The blocks were laid out again after the edit, so the new top is
+        // simply the block that many rows down
+        int moved = qMin(overflow, m_windowBlocks.size() - 1);
+        m_topOffset = m_windowBlocks.at(moved).start;
+
+        int column = cursor.positionInBlock();
+        QTextBlock block = m_editor->document()->findBlockByNumber(cursor.blockNumber() - moved);
+        cursor.setPosition(block.position() + qMin(column, block.length() - 1));
+        m_editor->setTextCursor(cursor);
+    }
+
+    refresh();
+    updateScrollBar();
+}
+
+void LargeFileView::showOffset(qint64 offset)
+{
+    if (!m_buffer.isOpen())
+        return;
+
+    // Bring the line containing the offset on screen, then put the cursor on it
+    int lastRow = qMin(m_windowBlocks.size(), visibleLineCount() - 1) - 1;
+    if (offset < m_topOffset || lastRow < 0 || offset > m_windowBlocks.at(lastRow).start + m_windowBlocks.at(lastRow).length)
+        scrollToOffset(offset);
+    else
+        refresh();
+
+    QTextCursor cursor(m_editor->document());
+    cursor.setPosition(qMin(positionAt(offset), m_editor->document()->characterCount() - 1));
+    m_editor->setTextCursor(cursor);
+}
+
+void LargeFileView::updateScrollBar()
+{
+    if (m_buffer.size() <= 0)
+        return;
+
+    const QSignalBlocker blocker(m_scrollBar);
+    m_scrollBar->setValue(static_cast<int>(m_topOffset * ScrollBarSteps / m_buffer.size()));
+}
+
+void LargeFileView::scrollBarMoved(int value)
+{
+    if (!m_buffer.isOpen() || m_buffer.size() <= 0)
+        return;
+
+    // Dragging maps linearly onto byte offsets; snap to the enclosing line
+    qint64 offset = m_buffer.size() * value / ScrollBarSteps;
+    m_topOffset = m_buffer.lineStart(offset, MaxLineBytes);
+    refresh();
+}
+
+void LargeFileView::updateLineNumbers()
+{
+    qint64 maxLine = m_buffer.lineCount();
+    m_editor->setLineNumberOffset(m_buffer.lineNumberAt(m_topOffset), qMax<qint64>(0, maxLine));
+}
+
+void LargeFileView::indexNextChunk()
+{
+    if (!m_buffer.isOpen()) {
+        m_indexTimer->stop();
+        return;
+    }
+
+    // Index a few chunks per event loop iteration to keep the UI responsive
+    bool topWasUnknown = m_buffer.lineNumberAt(m_topOffset) < 0;
+
+    for (int i = 0; i < 4; ++i) {
+        if (m_buffer.indexOriginal()) {
+            m_indexTimer->stop();
+            updateLineNumbers();
+            return;
+        }
+    }
+
+    if (topWasUnknown && m_buffer.lineNumberAt(m_topOffset) >= 0)
+        updateLineNumbers();
+}
+
+bool LargeFileView::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_editor->viewport()) {
+        if (event->type() == QEvent::Wheel) {
+            QWheelEvent *wheel = static_cast<QWheelEvent *>(event);
+            if (wheel->modifiers() & Qt::ControlModifier)
+                return false; // Let CodeEditor handle zooming
+
+            // Three lines per wheel notch, like QPlainTextEdit
+            scrollLines(-wheel->angleDelta().y() / 40);
+            return true;
+        }
+        if (event->type() == QEvent::Resize) {
+            QTimer::singleShot(0, this, &LargeFileView::refresh);
+        }
+        return false;
+    }
+
+    if (watched == m_editor && event->type() == QEvent::KeyPress) {
+        QKeyEvent *key = static_cast<QKeyEvent *>(event);
+
+        // The editor's own undo stack is disabled, history lives in the buffer
+        if (key->matches(QKeySequence::Undo)) {
+            undo();
+            return true;
+        }
+        if (key->matches(QKeySequence::Redo)) {
+            redo();
+            return true;
+        }
+
+        int row = m_editor->textCursor().blockNumber();
+        int pageLines = qMax(1, visibleLineCount() - 2);
+
+        switch (key->key()) {
+        case Qt::Key_PageDown:
+            scrollLines(pageLines);
+            return true;
+        case Qt::Key_PageUp:
+            scrollLines(-pageLines);
+            return true;
+        case Qt::Key_Down:
+            if (row >= pageLines) {
+                scrollLines(1);
+                return true;
+            }
+            break;
+        case Qt::Key_Up:
+            if (row == 0 && m_topOffset > 0) {
+                scrollLines(-1);
+                return true;
+            }
+            break;
+        case Qt::Key_Home:
+            if (key->modifiers() & Qt::ControlModifier) {
+                scrollToOffset(0);
+                return true;
+            }
+            break;
+        case Qt::Key_End:
+            if (key->modifiers() & Qt::ControlModifier) {
+                scrollToOffset(m_buffer.size());
+                return true;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    return QObject::eventFilter(watched, event);
+}
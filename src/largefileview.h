@@ -0,0 +1,120 @@
+#ifndef LARGEFILEVIEW_H
+#define LARGEFILEVIEW_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include "piecetable.h"
+#include "encodingdetector.h"
+#include "lineendings.h"
+
+class CodeEditor;
+class QScrollBar;
+class QTimer;
+
+// Editor for files too big to load into a QTextDocument. The file is
+// memory mapped behind a PieceTable and only the lines that fit in the
+// editor viewport are decoded and handed to the CodeEditor, so opening
+// time and memory use do not depend on the size of the file. Edits made
+// in the editor are mapped back to byte offsets and applied to the table.
+class LargeFileView : public QObject
+{
+    Q_OBJECT
+
+public:
+    LargeFileView(CodeEditor *editor, QScrollBar *scrollBar, QObject *parent = nullptr);
+    ~LargeFileView();
+
+    bool open(const QString &fileName);
+    bool reopen(const QString &fileName);
+
+    // A mapped file can't be replaced on every platform, so a save lets go
+    // of it once every byte has been read. Edits and undo history are kept;
+    // restoreFile() maps the unchanged file again if the save didn't happen.
+    void releaseFile();
+    bool restoreFile();
+    bool isReleased() const { return !m_buffer.isOpen(); }
+    QByteArray readBytes(qint64 pos, qint64 length) const { return m_buffer.text(pos, length); }
+    QString errorString() const { return m_errorString; }
+    qint64 fileSize() const { return m_buffer.size(); }
+    qint64 topOffset() const { return m_topOffset; }
+    bool isModified() const { return m_buffer.isModified(); }
+
+    // Only byte-oriented encodings are supported; binary data is shown
+    // as Latin-1 and cannot be edited
+    void setEncoding(EncodingDetector::Encoding encoding);
+
+    // Guessed from the start of the file; new lines are written in this style
+    LineEndingScanner::Style lineEndingStyle() const { return m_lineEnding; }
+    bool hasMixedLineEndings() const { return m_mixedLineEndings; }
+
+    void undo();
+    void redo();
+
+    void scrollToOffset(qint64 offset);
+    void scrollLines(int delta);
+    void refresh();
+
+signals:
+    void modificationChanged(bool modified);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void scrollBarMoved(int value);
+    void indexNextChunk();
+    void documentChanged(int position, int charsRemoved, int charsAdded);
+    void settleAfterEdit();
+
+private:
+    CodeEditor *m_editor;
+    QScrollBar *m_scrollBar;
+    QTimer *m_indexTimer;
+    PieceTable m_buffer;
+    QString m_errorString;
+    EncodingDetector::Encoding m_encoding;
+    LineEndingScanner::Style m_lineEnding;
+    bool m_mixedLineEndings;
+    qint64 m_topOffset;
+
+    // One block of the editor: the bytes its text was decoded from and the
+    // terminator after them. A line longer than MaxLineBytes is shown as
+    // several blocks with no terminator between them, and a lone CR ends
+    // a block just like LF and CRLF do.
+    struct WindowBlock {
+        qint64 start;
+        int length;
+        int terminator;
+        int position;           // of the block in the window text
+        QVector<int> offsets;   // byte offset of each character; empty
+                                // when every character is one byte
+    };
+
+    // What the editor currently shows: its text and where each of its
+    // blocks comes from. Used to map document positions back to byte
+    // offsets when the user edits the window.
+    QString m_windowText;
+    QVector<WindowBlock> m_windowBlocks;
+    bool m_updating;
+    bool m_settlePending;
+
+    int visibleLineCount() const;
+    QString decode(const QByteArray &bytes, QVector<int> *offsets) const;
+    QByteArray encode(const QString &text) const;
+    WindowBlock blockAt(qint64 pos, QByteArray *bytes) const;
+    qint64 nextBlockStart(qint64 pos) const;
+    QString layoutWindow(int maxBlocks);
+    qint64 byteOffsetAt(int position) const;
+    int positionAt(qint64 offset) const;
+    void rebuildWindowLines();
+    void showOffset(qint64 offset);
+    void updateScrollBar();
+    void updateLineNumbers();
+
+    static const qint64 MaxLineBytes = 64 * 1024;
+    static const qint64 LineEndingSample = 64 * 1024;
+    static const int ScrollBarSteps = 1000000;
+};
+
+#endif // LARGEFILEVIEW_H
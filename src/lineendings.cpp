@@ -0,0 +1,136 @@
+#include "lineendings.h"
+#include <QtAlgorithms>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NOTEPADX_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define NOTEPADX_NEON
+#include <arm_neon.h>
+#endif
+
+LineEndingScanner::LineEndingScanner() : m_line(0)
+{
+    m_counts[Lf] = m_counts[CrLf] = m_counts[Cr] = 0;
+}
+
+void LineEndingScanner::record(Style style, qint64 lines)
+{
+    if (m_runs.isEmpty() || m_runs.last().style != style) {
+        Run run = { m_line, style };
+        m_runs.append(run);
+    }
+    m_counts[style] += lines;
+    m_line += lines;
+}
+
+void LineEndingScanner::scan(QString &text)
+{
+    const ushort *src = text.utf16();
+    const int size = text.size();
+    int i = 0;
+
+    // Plain LF text needs no rewriting, so count newlines eight characters
+    // at a time until the first carriage return shows up
+#if defined(NOTEPADX_SSE2)
+    const __m128i newline = _mm_set1_epi16('\n');
+    const __m128i carriageReturn = _mm_set1_epi16('\r');
+    for (; i + 8 <= size; i += 8) {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(chars, carriageReturn)))
+            break;
+        quint32 mask = static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi16(chars, newline)));
+        if (mask)
+            record(Lf, qPopulationCount(mask) / 2);
+    }
+#elif defined(NOTEPADX_NEON)
+    const uint16x8_t newline = vdupq_n_u16('\n');
+    const uint16x8_t carriageReturn = vdupq_n_u16('\r');
+    for (; i + 8 <= size; i += 8) {
+        uint16x8_t chars = vld1q_u16(src + i);
+        if (vmaxvq_u16(vceqq_u16(chars, carriageReturn)))
+            break;
+        uint16_t lines = vaddvq_u16(vshrq_n_u16(vceqq_u16(chars, newline), 15));
+        if (lines)
+            record(Lf, lines);
+    }
+#endif
+    for (; i < size && src[i] != '\r'; ++i) {
+        if (src[i] == '\n')
+            record(Lf, 1);
+    }
+    if (i == size)
+        return;
+
+    // Rewrite CRLF and lone CR to '\n' in place from here on
+    QChar *data = text.data();
+    int out = i;
+    for (; i < size; ++i) {
+        ushort c = data[i].unicode();
+        if (c == '\r') {
+            if (i + 1 < size && data[i + 1] == QLatin1Char('\n')) {
+                record(CrLf, 1);
+                ++i;
+            } else {
+                record(Cr, 1);
+            }
+            data[out++] = QLatin1Char('\n');
+        } else {
+            if (c == '\n')
+                record(Lf, 1);
+            data[out++] = data[i];
+        }
+    }
+    text.truncate(out);
+}
+
+LineEndingScanner::Style LineEndingScanner::dominantStyle() const
+{
+    if (m_line == 0)
+        return platformDefault();
+
+    Style style = Lf;
+    if (m_counts[CrLf] > m_counts[style])
+        style = CrLf;
+    if (m_counts[Cr] > m_counts[style])
+        style = Cr;
+    return style;
+}
+
+bool LineEndingScanner::isMixed() const
+{
+    return m_runs.size() > 1;
+}
+
+QString LineEndingScanner::name(Style style)
+{
+    switch (style) {
+    case CrLf:
+        return QStringLiteral("CRLF");
+    case Cr:
+        return QStringLiteral("CR");
+    default:
+        return QStringLiteral("LF");
+    }
+}
+
+QString LineEndingScanner::sequence(Style style)
+{
+    switch (style) {
+    case CrLf:
+        return QStringLiteral("\r\n");
+    case Cr:
+        return QStringLiteral("\r");
+    default:
+        return QStringLiteral("\n");
+    }
+}
+
+LineEndingScanner::Style LineEndingScanner::platformDefault()
+{
+#ifdef Q_OS_WIN
+    return CrLf;
+#else
+    return Lf;
+#endif
+}
@@ -0,0 +1,52 @@
+#ifndef LINEENDINGS_H
+#define LINEENDINGS_H
+
+#include <QString>
+#include <QVector>
+#include <QTextFormat>
+
+// Counts the line terminators of decoded text and rewrites them to '\n'
+// in the same pass, remembering where the style changes so that mixed
+// files can be written back exactly as they were read.
+class LineEndingScanner
+{
+public:
+    enum Style {
+        Lf,
+        CrLf,
+        Cr
+    };
+
+    // A run of consecutive lines sharing one terminator style
+    struct Run {
+        qint64 firstLine;
+        Style style;
+    };
+
+    LineEndingScanner();
+
+    // Text must not end between a '\r' and the '\n' following it
+    void scan(QString &text);
+
+    Style dominantStyle() const;
+    bool isMixed() const;
+    qint64 lineCount() const { return m_line; }
+    const QVector<Run> &runs() const { return m_runs; }
+
+    static QString name(Style style);
+    static QString sequence(Style style);
+    static Style platformDefault();
+
+    // Block format property carrying the terminator of lines whose style
+    // differs from the dominant one of their document
+    static const int BlockProperty = QTextFormat::UserProperty + 1;
+
+private:
+    qint64 m_counts[3];
+    qint64 m_line;
+    QVector<Run> m_runs;
+
+    void record(Style style, qint64 lines);
+};
+
+#endif // LINEENDINGS_H
@@ -27,8 +27,12 @@ void LineNumberArea::paintEvent(QPaintEvent *event)
     // Use the same font as the editor for line numbers
     painter.setFont(codeEditor->font());
     
+    // Editors showing a window of a larger file may not know their position yet
+    if (codeEditor->lineNumberOffset < 0)
+        return;
+    
     QTextBlock block = codeEditor->firstVisibleBlock();
-    int blockNumber = block.blockNumber();
+    qint64 blockNumber = block.blockNumber() + codeEditor->lineNumberOffset;
     int top = qRound(codeEditor->blockBoundingGeometry(block).translated(codeEditor->contentOffset()).top());
     int bottom = top + qRound(codeEditor->blockBoundingRect(block).height());
     
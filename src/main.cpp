@@ -1,6 +1,6 @@
 #include "mainwindow.h"
+#include "startuptrace.h"
 #include <QApplication>
-#include <QFontDatabase>
 #include <QDebug>
 #include <QtSvg> // Add SVG module header
 #include <QDir>
@@ -12,14 +12,7 @@
 
 // Debug helper function
 void showDebugMessage(const QString& message) {
-    qDebug() << message;
-    std::cout << message.toStdString() << std::endl;
-    QFile file("crash_log.txt");
-    if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
-        QTextStream stream(&file);
-        stream << message << "\n";
-        file.close();
-    }
+    StartupTrace::log(message);
 }
 
 #ifdef Q_OS_WIN
@@ -30,14 +23,16 @@ void showDebugMessage(const QString& message) {
 
 int main(int argc, char *argv[])
 {
-    // Create an empty crash log file
-    QFile crashFile("crash_log.txt");
-    if (crashFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-        QTextStream stream(&crashFile);
-        stream << "Starting application...\n";
-        stream << "Current directory: " << QDir::currentPath() << "\n";
-        crashFile.close();
+    // Checked before QApplication exists, so its construction is timed too
+    bool startupTrace = false;
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--startup-trace") == 0) {
+            startupTrace = true;
+        }
     }
+    StartupTrace::begin(startupTrace);
+    showDebugMessage("Starting application...");
+    showDebugMessage(QString("Current directory: %1").arg(QDir::currentPath()));
 
     try {
         showDebugMessage("Initializing application");
@@ -46,59 +41,10 @@ int main(int argc, char *argv[])
         QApplication app(argc, argv);
         
         showDebugMessage("Application initialized");
+        StartupTrace::mark("application created");
         
-        // Debug resource system
-        showDebugMessage("Checking resource files");
-        QStringList svgPaths = {
-            ":/icons/new.svg", 
-            ":/icons/open.svg",
-            ":/icons/save.svg"
-        };
-        
-        for (const QString &path : svgPaths) {
-            QFile file(path);
-            showDebugMessage(QString("%1 exists: %2").arg(path).arg(file.exists()));
-            if (file.exists()) {
-                showDebugMessage(QString("  Size: %1 bytes").arg(file.size()));
-            }
-        }
-        
-        // Debug resource paths
-        showDebugMessage(QString("Working directory: %1").arg(QDir::currentPath()));
-        showDebugMessage(QString("Resource file check: Font Awesome exists: %1").arg(QFile::exists(":/fonts/fontawesome-webfont.ttf")));
-        showDebugMessage(QString("Resource file check: SVG icon exists: %1").arg(QFile::exists(":/icons/new.svg")));
-        
-        // List resources directories
-        QDir resRoot(":/");
-        showDebugMessage(QString("Resource root dirs: %1").arg(resRoot.entryList(QDir::Dirs).join(", ")));
-        
-        // Debug resource paths
-        showDebugMessage(QString("Application directory: %1").arg(QDir::currentPath()));
-        showDebugMessage(QString("Resource file exists: %1").arg(QFile::exists(":/icons/new.svg")));
-        
-        // List all resources
-        showDebugMessage("Available resources:");
-        QDir resourceDir(":/");
-        showDebugMessage(resourceDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot).join(", "));
-        
-        if (resourceDir.exists("icons")) {
-            QDir iconDir(":/icons");
-            showDebugMessage("Icons available:");
-            showDebugMessage(iconDir.entryList(QDir::Files).join(", "));
-        } else {
-            showDebugMessage("Icons directory not found in resources.");
-        }
-        
-        // Load FontAwesome font
-        int fontId = QFontDatabase::addApplicationFont(":/fonts/fontawesome-webfont.ttf");
-        if (fontId != -1) {
-            QStringList fontFamilies = QFontDatabase::applicationFontFamilies(fontId);
-            if (!fontFamilies.isEmpty()) {
-                showDebugMessage(QString("FontAwesome loaded: %1").arg(fontFamilies.at(0)));
-            }
-        } else {
-            showDebugMessage("Failed to load FontAwesome");
-        }
+        // Resource checks and the icon font are left to MainWindow, which
+        // runs them once the window has been painted
         
         // Set application metadata
         QApplication::setApplicationName("NotepadX");
@@ -195,14 +141,17 @@ int main(int argc, char *argv[])
         // They will be managed by the SVG icon provider system
 #endif
         
+        StartupTrace::mark("application icon set");
         showDebugMessage("Creating main window");
         
         try {
             MainWindow window;
             showDebugMessage("Main window created");
+            StartupTrace::mark("main window created");
             
             window.show();
             showDebugMessage("Window shown");
+            StartupTrace::mark("window shown");
             
             return app.exec();
         }
@@ -219,22 +168,12 @@ int main(int argc, char *argv[])
     }
     catch (const std::exception& e) {
         std::cerr << "Exception: " << e.what() << std::endl;
-        QFile file("crash_log.txt");
-        if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
-            QTextStream stream(&file);
-            stream << "FATAL EXCEPTION: " << e.what() << "\n";
-            file.close();
-        }
+        StartupTrace::log(QString("FATAL EXCEPTION: %1").arg(e.what()));
         return 1;
     }
     catch (...) {
         std::cerr << "Unknown exception" << std::endl;
-        QFile file("crash_log.txt");
-        if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
-            QTextStream stream(&file);
-            stream << "FATAL UNKNOWN EXCEPTION\n";
-            file.close();
-        }
+        StartupTrace::log("FATAL UNKNOWN EXCEPTION");
         return 1;
     }
 }
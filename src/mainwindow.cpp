@@ -26,17 +26,31 @@
 #include <QStandardPaths>
 #include <QDebug>
 #include <QFile>
+#include <QDir>
+#include <QTimer>
 #include "fonticon.h"
 #include "svgiconprovider.h"
+#include "startuptrace.h"
 
 // Debug helper function - make it static to avoid multiple definition error
 static void debugLogMessage(const QString& message) {
-    qDebug() << message;
-    QFile file("crash_log.txt");
-    if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
-        QTextStream stream(&file);
-        stream << message << "\n";
-        file.close();
+    StartupTrace::log(message);
+}
+
+// Startup diagnostics that used to run in main() before the window existed
+static void logResourceChecks()
+{
+    debugLogMessage(QString("Resource file check: Font Awesome exists: %1").arg(QFile::exists(":/fonts/fontawesome-webfont.ttf")));
+    debugLogMessage(QString("Resource file check: SVG icon exists: %1").arg(QFile::exists(":/icons/new.svg")));
+    
+    QDir resourceDir(":/");
+    debugLogMessage(QString("Resource root dirs: %1").arg(resourceDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot).join(", ")));
+    if (resourceDir.exists("icons")) {
+        QDir iconDir(":/icons");
+        debugLogMessage("Icons available:");
+        debugLogMessage(iconDir.entryList(QDir::Files).join(", "));
+    } else {
+        debugLogMessage("Icons directory not found in resources.");
     }
 }
 
@@ -52,12 +66,16 @@ MainWindow::MainWindow(QWidget *parent)
         fileOps = nullptr;
         editorMgr = nullptr;
         searchMgr = nullptr;
+        firstPaintSeen = false;
 
         // Create the UI components first
         debugLogMessage("Creating tab widget");
         createTabWidget();
         debugLogMessage("Tab widget created");
         
+        // The first paint of the tab widget ends the critical startup phase
+        tabWidget->installEventFilter(this);
+        
         // Create menus before status bar and managers
         debugLogMessage("Creating menus");
         createMenus();
@@ -70,6 +88,7 @@ MainWindow::MainWindow(QWidget *parent)
         debugLogMessage("Creating status bar");
         createStatusBar();
         debugLogMessage("Status bar created");
+        StartupTrace::mark("menus, toolbar and status bar");
 
         // Read settings for word wrap to update UI
         QSettings settings("NotepadX", "Editor");
@@ -100,11 +119,13 @@ MainWindow::MainWindow(QWidget *parent)
         debugLogMessage("Creating search manager");
         searchMgr = new SearchManager(this);
         debugLogMessage("Search manager created");
+        StartupTrace::mark("managers created");
         
         // Load settings
         debugLogMessage("Reading settings");
         readSettings();
         debugLogMessage("Settings read");
+        StartupTrace::mark("settings and session restored");
         
         // Only create a new tab if no tabs were restored from session
         if (tabWidget->count() == 0)
@@ -363,7 +384,15 @@ void MainWindow::createMenus()
     wordWrapAction->setChecked(wordWrapEnabled);
     
     viewMenu->addAction(wordWrapAction);
-    connect(wordWrapAction, &QAction::triggered, this, &MainWindow::toggleWordWrap);    QMenu *languageMenu = menuBar()->addMenu("&Language");
+    connect(wordWrapAction, &QAction::triggered, this, &MainWindow::toggleWordWrap);
+
+    // Follow mode keeps appending what other programs write to the file
+    QAction *followAction = new QAction("&Follow File", this);
+    followAction->setCheckable(true);
+    viewMenu->addAction(followAction);
+    connect(followAction, &QAction::triggered, this, &MainWindow::toggleFollowMode);
+
+    QMenu *languageMenu = menuBar()->addMenu("&Language");
     languageActionGroup = new QActionGroup(this);
     connect(languageActionGroup, &QActionGroup::triggered, this, &MainWindow::languageSelected);
 
@@ -405,6 +434,10 @@ void MainWindow::createToolBar()
     {
         newIcon = FontIcon::icon(FontIcon::FA_FILE);
     }
+    else
+    {
+        newAction->setProperty("svgIcon", "new");
+    }
     newAction->setIcon(newIcon);
     connect(newAction, &QAction::triggered, this, &MainWindow::createNewTab);
 
@@ -414,6 +447,10 @@ void MainWindow::createToolBar()
     {
         openIcon = FontIcon::icon(FontIcon::FA_FOLDER_OPEN);
     }
+    else
+    {
+        openAction->setProperty("svgIcon", "open");
+    }
     openAction->setIcon(openIcon);
     connect(openAction, &QAction::triggered, this, &MainWindow::openFile);
 
@@ -423,6 +460,10 @@ void MainWindow::createToolBar()
     {
         saveIcon = FontIcon::icon(FontIcon::FA_SAVE);
     }
+    else
+    {
+        saveAction->setProperty("svgIcon", "save");
+    }
     saveAction->setIcon(saveIcon);
     connect(saveAction, &QAction::triggered, this, &MainWindow::saveFile);
 
@@ -434,6 +475,10 @@ void MainWindow::createToolBar()
     {
         cutIcon = FontIcon::icon(FontIcon::FA_CUT);
     }
+    else
+    {
+        cutAction->setProperty("svgIcon", "cut");
+    }
     cutAction->setIcon(cutIcon);
     cutAction->setToolTip(QString("Cut (Ctrl+X)"));
     connect(cutAction, &QAction::triggered, this, [this]()
@@ -450,6 +495,10 @@ void MainWindow::createToolBar()
     {
         copyIcon = FontIcon::icon(FontIcon::FA_COPY);
     }
+    else
+    {
+        copyAction->setProperty("svgIcon", "copy");
+    }
     copyAction->setIcon(copyIcon);
     copyAction->setToolTip(QString("Copy (Ctrl+C)"));
     connect(copyAction, &QAction::triggered, this, [this]()
@@ -466,6 +515,10 @@ void MainWindow::createToolBar()
     {
         pasteIcon = FontIcon::icon(FontIcon::FA_PASTE);
     }
+    else
+    {
+        pasteAction->setProperty("svgIcon", "paste");
+    }
     pasteAction->setIcon(pasteIcon);
     pasteAction->setToolTip(QString("Paste (Ctrl+V)"));
     connect(pasteAction, &QAction::triggered, this, [this]()
@@ -484,6 +537,10 @@ void MainWindow::createToolBar()
     {
         undoIcon = FontIcon::icon(FontIcon::FA_UNDO);
     }
+    else
+    {
+        undoAction->setProperty("svgIcon", "undo");
+    }
     undoAction->setIcon(undoIcon);
     undoAction->setToolTip(QString("Undo (Ctrl+Z)"));
     connect(undoAction, &QAction::triggered, this, [this]()
@@ -500,6 +557,10 @@ void MainWindow::createToolBar()
     {
         redoIcon = FontIcon::icon(FontIcon::FA_REPEAT);
     }
+    else
+    {
+        redoAction->setProperty("svgIcon", "redo");
+    }
     redoAction->setIcon(redoIcon);
     redoAction->setToolTip(QString("Redo (Ctrl+Y)"));
     connect(redoAction, &QAction::triggered, this, [this]()
@@ -527,6 +588,11 @@ void MainWindow::createStatusBar()
         statusBar()->addPermanentWidget(zoomLabel);
         debugLogMessage("Zoom label created");
 
+        lineEndingLabel = new QLabel("", this);
+        lineEndingLabel->setMinimumWidth(60);
+        statusBar()->addPermanentWidget(lineEndingLabel);
+        debugLogMessage("Line ending label created");
+
         modifiedLabel = new QLabel("", this);
         modifiedLabel->setMinimumWidth(80);
         statusBar()->addPermanentWidget(modifiedLabel);
@@ -681,6 +747,11 @@ void MainWindow::toggleWordWrap()
     editorMgr->toggleWordWrap();
 }
 
+void MainWindow::toggleFollowMode()
+{
+    editorMgr->toggleFollowMode();
+}
+
 void MainWindow::showAboutDialog()
 {
     QMessageBox msgBox(this);
@@ -698,6 +769,12 @@ void MainWindow::showAboutDialog()
 
 bool MainWindow::eventFilter(QObject *watched, QEvent *event)
 {
+    if (watched == tabWidget && event->type() == QEvent::Paint && !firstPaintSeen)
+    {
+        // Let this paint reach the screen before doing anything else
+        firstPaintSeen = true;
+        QTimer::singleShot(0, this, &MainWindow::runDeferredStartup);
+    }
     if (watched == tabWidget->tabBar())
     {
         if (event->type() == QEvent::HoverMove || event->type() == QEvent::HoverEnter)
@@ -708,6 +785,33 @@ bool MainWindow::eventFilter(QObject *watched, QEvent *event)
     return QMainWindow::eventFilter(watched, event);
 }
 
+void MainWindow::runDeferredStartup()
+{
+    StartupTrace::mark("first paint");
+    
+    // Nothing below is needed to show the window or edit the active tab
+    if (fileOps) {
+        fileOps->validateRecentFiles();
+    }
+    StartupTrace::mark("recent files validated");
+    
+    if (!FontIcon::loadFont()) {
+        debugLogMessage("Failed to load FontAwesome");
+    }
+    QStringList iconNames;
+    for (QAction *action : findChildren<QAction*>()) {
+        QString iconName = action->property("svgIcon").toString();
+        if (!iconName.isEmpty()) {
+            iconNames.append(iconName);
+        }
+    }
+    SvgIconProvider::prewarm(iconNames);
+    StartupTrace::mark("icons prewarmed");
+    
+    logResourceChecks();
+    StartupTrace::mark("resources checked");
+}
+
 void MainWindow::readSettings()
 {
     QSettings settings("NotepadX", "Editor");
@@ -25,6 +25,7 @@ public:
     // Provide access to status bar labels for modules
     QLabel* getLineColumnLabel() { return lineColumnLabel; }
     QLabel* getZoomLabel() { return zoomLabel; }
+    QLabel* getLineEndingLabel() { return lineEndingLabel; }
     QLabel* getModifiedLabel() { return modifiedLabel; }
     QLabel* getFilenameLabel() { return filenameLabel; }
 
@@ -71,6 +72,10 @@ private slots:
     
     // Add word wrap slot
     void toggleWordWrap();
+    void toggleFollowMode();
+    
+    // Work left out of startup until the window has been painted once
+    void runDeferredStartup();
 
 private:
     // Core UI components
@@ -79,6 +84,7 @@ private:
     // Status bar labels
     QLabel *lineColumnLabel;
     QLabel *zoomLabel;
+    QLabel *lineEndingLabel;
     QLabel *modifiedLabel;
     QLabel *filenameLabel;
       // Module classes that handle specific functionality
@@ -88,6 +94,7 @@ private:
       // UI components
     QActionGroup *languageActionGroup;
     QActionGroup *themeActionGroup;
+    bool firstPaintSeen;
     
     // UI setup methods
     void createMenus();
@@ -0,0 +1,112 @@
+#include "mappedfile.h"
+#include <cstring>
+
+MappedFile::MappedFile() : m_data(nullptr), m_size(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const QString &fileName)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    m_size = m_file.size();
+    if (m_size <= 0) {
+        m_file.close();
+        m_size = 0;
+        return false;
+    }
+
+    m_data = m_file.map(0, m_size);
+    if (!m_data) {
+        m_file.close();
+        m_size = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data) {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+    if (m_file.isOpen())
+        m_file.close();
+    m_size = 0;
+}
+
+qint64 MappedFile::lineStart(qint64 offset, qint64 limit) const
+{
+    if (!m_data || offset <= 0)
+        return 0;
+
+    offset = qMin(offset, m_size);
+    const char *base = data();
+    const char *p = base + offset;
+    const char *stop = (limit > 0 && offset > limit) ? p - limit : base;
+
+    // Walk backwards until we hit the newline that terminates the previous line
+    while (p > stop && p[-1] != '\n')
+        --p;
+
+    return p - base;
+}
+
+qint64 MappedFile::nextLineStart(qint64 offset, qint64 limit) const
+{
+    if (!m_data || offset >= m_size)
+        return m_size;
+
+    offset = qMax<qint64>(0, offset);
+    qint64 length = m_size - offset;
+    if (limit > 0)
+        length = qMin(length, limit);
+
+    const void *hit = std::memchr(data() + offset, '\n', static_cast<size_t>(length));
+    if (!hit)
+        return offset + length;
+
+    return static_cast<const char *>(hit) - data() + 1;
+}
+
+qint64 MappedFile::previousLineStart(qint64 offset, qint64 limit) const
+{
+    qint64 start = lineStart(offset, limit);
+    if (start == 0)
+        return 0;
+
+    // Step over the newline ending the previous line, then find its start
+    return lineStart(start - 1, limit);
+}
+
+qint64 MappedFile::countNewlines(qint64 from, qint64 to) const
+{
+    if (!m_data)
+        return 0;
+
+    from = qBound<qint64>(0, from, m_size);
+    to = qBound<qint64>(0, to, m_size);
+
+    qint64 count = 0;
+    const char *p = data() + from;
+    const char *end = data() + to;
+    while (p < end) {
+        const void *hit = std::memchr(p, '\n', static_cast<size_t>(end - p));
+        if (!hit)
+            break;
+        ++count;
+        p = static_cast<const char *>(hit) + 1;
+    }
+    return count;
+}
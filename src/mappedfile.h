@@ -0,0 +1,41 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <QFile>
+#include <QString>
+
+// Read-only memory mapping of a file on disk. Pages are only brought into
+// memory by the OS when they are touched, so opening is constant time and
+// the resident set is bounded by what is actually read.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+    QString fileName() const { return m_file.fileName(); }
+    QString errorString() const { return m_file.errorString(); }
+
+    qint64 size() const { return m_size; }
+    const char *data() const { return reinterpret_cast<const char *>(m_data); }
+
+    // Line navigation helpers - all offsets are byte offsets into the file.
+    // A positive limit caps how far a single call scans, so pathological
+    // files with multi-megabyte lines are split into segments of that size.
+    qint64 lineStart(qint64 offset, qint64 limit = -1) const;
+    qint64 nextLineStart(qint64 offset, qint64 limit = -1) const;
+    qint64 previousLineStart(qint64 offset, qint64 limit = -1) const;
+    qint64 countNewlines(qint64 from, qint64 to) const;
+
+private:
+    QFile m_file;
+    uchar *m_data;
+    qint64 m_size;
+
+    Q_DISABLE_COPY(MappedFile)
+};
+
+#endif // MAPPEDFILE_H
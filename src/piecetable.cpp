@@ -0,0 +1,417 @@
+#include "piecetable.h"
+#include <algorithm>
+#include <cstring>
+
+PieceTable::PieceTable() : m_releasedSize(-1), m_size(0), m_savePoint(0), m_grouping(false), m_groupOpen(false)
+{
+    m_originalCheckpoints.append(0);
+}
+
+PieceTable::~PieceTable()
+{
+    close();
+}
+
+bool PieceTable::open(const QString &fileName)
+{
+    close();
+
+    if (!m_original.open(fileName))
+        return false;
+
+    m_pieces.append(makePiece(Original, 0, m_original.size()));
+    updatePieceStarts(0);
+    return true;
+}
+
+void PieceTable::close()
+{
+    m_original.close();
+    m_releasedSize = -1;
+    m_add.clear();
+    m_pieces.clear();
+    m_pieceStarts.clear();
+    m_size = 0;
+    m_undoStack.clear();
+    m_redoStack.clear();
+    m_savePoint = 0;
+    m_originalCheckpoints.clear();
+    m_originalCheckpoints.append(0);
+}
+
+void PieceTable::releaseOriginal()
+{
+    if (!m_original.isOpen())
+        return;
+    m_releasedSize = m_original.size();
+    m_original.close();
+}
+
+bool PieceTable::remapOriginal()
+{
+    if (m_releasedSize < 0)
+        return m_original.isOpen();
+
+    // The pieces point into the old contents by offset, so only the same
+    // bytes will do; a size check is the cheap part of that promise
+    qint64 expected = m_releasedSize;
+    m_releasedSize = -1;
+    if (!m_original.open(m_original.fileName()) || m_original.size() != expected) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+const char *PieceTable::pieceData(const Piece &piece) const
+{
+    if (piece.source == Original)
+        return m_original.data() + piece.start;
+    return m_add.constData() + piece.start;
+}
+
+int PieceTable::findPiece(qint64 pos) const
+{
+    if (pos >= m_size)
+        return m_pieces.size();
+
+    // Last piece starting at or before pos
+    auto it = std::upper_bound(m_pieceStarts.constBegin(), m_pieceStarts.constEnd(), pos);
+    return static_cast<int>(it - m_pieceStarts.constBegin()) - 1;
+}
+
+void PieceTable::updatePieceStarts(int from)
+{
+    m_pieceStarts.resize(m_pieces.size());
+
+    qint64 pos = 0;
+    if (from > 0)
+        pos = m_pieceStarts.at(from - 1) + m_pieces.at(from - 1).length;
+
+    for (int i = from; i < m_pieces.size(); ++i) {
+        m_pieceStarts[i] = pos;
+        pos += m_pieces.at(i).length;
+    }
+    m_size = pos;
+}
+
+PieceTable::Piece PieceTable::makePiece(Source source, qint64 start, qint64 length) const
+{
+    Piece piece = { source, start, length, -1 };
+    piece.newlines = countNewlines(piece, 0, length);
+    return piece;
+}
+
+qint64 PieceTable::originalNewlinesBefore(qint64 offset) const
+{
+    qint64 chunk = offset / IndexChunkSize;
+    if (chunk >= m_originalCheckpoints.size())
+        return -1;
+
+    return m_originalCheckpoints.at(static_cast<int>(chunk))
+        + m_original.countNewlines(chunk * IndexChunkSize, offset);
+}
+
+qint64 PieceTable::countNewlines(const Piece &piece, qint64 from, qint64 to) const
+{
+    if (piece.source == Original) {
+        // Bounded by the index granularity, never by the size of the piece
+        qint64 before = originalNewlinesBefore(piece.start + from);
+        qint64 after = originalNewlinesBefore(piece.start + to);
+        return (before < 0 || after < 0) ? -1 : after - before;
+    }
+
+    qint64 count = 0;
+    const char *p = m_add.constData() + piece.start + from;
+    const char *end = m_add.constData() + piece.start + to;
+    while (p < end) {
+        const void *hit = std::memchr(p, '\n', static_cast<size_t>(end - p));
+        if (!hit)
+            break;
+        ++count;
+        p = static_cast<const char *>(hit) + 1;
+    }
+    return count;
+}
+
+QByteArray PieceTable::text(qint64 pos, qint64 length) const
+{
+    pos = qBound<qint64>(0, pos, m_size);
+    length = qBound<qint64>(0, length, m_size - pos);
+
+    QByteArray result;
+    result.reserve(static_cast<int>(length));
+
+    for (int index = findPiece(pos); length > 0 && index < m_pieces.size(); ++index) {
+        const Piece &piece = m_pieces.at(index);
+        qint64 offset = pos - m_pieceStarts.at(index);
+        qint64 n = qMin(piece.length - offset, length);
+        result.append(pieceData(piece) + offset, static_cast<int>(n));
+        pos += n;
+        length -= n;
+    }
+    return result;
+}
+
+void PieceTable::insert(qint64 pos, const QByteArray &bytes)
+{
+    if (bytes.isEmpty())
+        return;
+
+    pos = qBound<qint64>(0, pos, m_size);
+    qint64 addStart = m_add.size();
+    m_add.append(bytes);
+    Piece piece = makePiece(Add, addStart, bytes.size());
+
+    Step step;
+    int index = findPiece(pos);
+    if (index < m_pieces.size() && pos > m_pieceStarts.at(index)) {
+        // Split the piece around the insertion point
+        const Piece &target = m_pieces.at(index);
+        qint64 offset = pos - m_pieceStarts.at(index);
+        step.index = index;
+        step.removed.append(target);
+        step.inserted.append(makePiece(target.source, target.start, offset));
+        step.inserted.append(piece);
+        step.inserted.append(makePiece(target.source, target.start + offset, target.length - offset));
+    } else if (index > 0 && m_pieces.at(index - 1).source == Add
+               && m_pieces.at(index - 1).start + m_pieces.at(index - 1).length == addStart) {
+        // Typing straight after the previous insert just grows its piece
+        Piece grown = m_pieces.at(index - 1);
+        grown.length += piece.length;
+        grown.newlines = grown.newlines < 0 ? -1 : grown.newlines + piece.newlines;
+        step.index = index - 1;
+        step.removed.append(m_pieces.at(index - 1));
+        step.inserted.append(grown);
+    } else {
+        step.index = index;
+        step.inserted.append(piece);
+    }
+
+    applyStep(step.index, step.removed, step.inserted);
+    recordStep(step, pos, pos + bytes.size(), bytes.size() < 16 && !bytes.contains('\n'));
+}
+
+void PieceTable::remove(qint64 pos, qint64 length)
+{
+    pos = qBound<qint64>(0, pos, m_size);
+    length = qMin(length, m_size - pos);
+    if (length <= 0)
+        return;
+
+    int first = findPiece(pos);
+    int last = findPiece(pos + length - 1);
+
+    Step step;
+    step.index = first;
+    step.removed = m_pieces.mid(first, last - first + 1);
+
+    // Keep whatever part of the first and last piece lies outside the range
+    const Piece &head = m_pieces.at(first);
+    qint64 headLength = pos - m_pieceStarts.at(first);
+    if (headLength > 0)
+        step.inserted.append(makePiece(head.source, head.start, headLength));
+
+    const Piece &tail = m_pieces.at(last);
+    qint64 tailOffset = pos + length - m_pieceStarts.at(last);
+    if (tailOffset < tail.length)
+        step.inserted.append(makePiece(tail.source, tail.start + tailOffset, tail.length - tailOffset));
+
+    applyStep(step.index, step.removed, step.inserted);
+    recordStep(step, pos, pos, false);
+}
+
+void PieceTable::applyStep(int index, const QVector<Piece> &removed, const QVector<Piece> &inserted)
+{
+    m_pieces.remove(index, removed.size());
+    for (int i = 0; i < inserted.size(); ++i) {
+        Piece piece = inserted.at(i);
+        // Pieces recorded before the index reached them can be counted now
+        if (piece.newlines < 0)
+            piece.newlines = countNewlines(piece, 0, piece.length);
+        m_pieces.insert(index + i, piece);
+    }
+    updatePieceStarts(index);
+}
+
+void PieceTable::recordStep(const Step &step, qint64 position, qint64 end, bool typing)
+{
+    m_redoStack.clear();
+    if (m_savePoint > m_undoStack.size())
+        m_savePoint = -1;   // The saved state can no longer be reached
+
+    if (m_grouping && m_groupOpen) {
+        m_undoStack.last().steps.append(step);
+        m_undoStack.last().end = end;
+        return;
+    }
+
+    // Merge runs of typed characters so they undo as one step, but never
+    // across the save point or the modified state would be lost
+    if (typing && !m_undoStack.isEmpty() && m_savePoint != m_undoStack.size()) {
+        Edit &last = m_undoStack.last();
+        if (last.typing && last.end == position) {
+            last.steps.append(step);
+            last.end = end;
+            return;
+        }
+    }
+
+    Edit edit;
+    edit.steps.append(step);
+    edit.position = position;
+    edit.end = end;
+    edit.typing = typing && !m_grouping;
+    m_undoStack.append(edit);
+    m_groupOpen = m_grouping;
+}
+
+void PieceTable::beginGroup()
+{
+    m_grouping = true;
+    m_groupOpen = false;
+}
+
+void PieceTable::endGroup()
+{
+    m_grouping = false;
+    m_groupOpen = false;
+}
+
+qint64 PieceTable::undo()
+{
+    if (m_undoStack.isEmpty())
+        return -1;
+
+    Edit edit = m_undoStack.takeLast();
+    for (int i = edit.steps.size() - 1; i >= 0; --i) {
+        const Step &step = edit.steps.at(i);
+        applyStep(step.index, step.inserted, step.removed);
+    }
+
+    // A redone edit must not be merged with new typing
+    edit.typing = false;
+    m_redoStack.append(edit);
+    return edit.position;
+}
+
+qint64 PieceTable::redo()
+{
+    if (m_redoStack.isEmpty())
+        return -1;
+
+    Edit edit = m_redoStack.takeLast();
+    for (const Step &step : edit.steps)
+        applyStep(step.index, step.removed, step.inserted);
+
+    m_undoStack.append(edit);
+    return edit.end;
+}
+
+qint64 PieceTable::lineStart(qint64 offset, qint64 limit) const
+{
+    if (offset <= 0 || m_size == 0)
+        return 0;
+
+    offset = qMin(offset, m_size);
+    qint64 stop = (limit > 0 && offset > limit) ? offset - limit : 0;
+
+    // Walk backwards until we hit the newline that terminates the previous line
+    qint64 pos = offset;
+    for (int index = findPiece(pos - 1); pos > stop && index >= 0; --index) {
+        const char *data = pieceData(m_pieces.at(index));
+        qint64 pieceStart = m_pieceStarts.at(index);
+        qint64 from = qMax(pieceStart, stop);
+        for (; pos > from; --pos) {
+            if (data[pos - 1 - pieceStart] == '\n')
+                return pos;
+        }
+    }
+    return pos;
+}
+
+qint64 PieceTable::nextLineStart(qint64 offset, qint64 limit) const
+{
+    if (offset >= m_size)
+        return m_size;
+
+    offset = qMax<qint64>(0, offset);
+    qint64 end = limit > 0 ? qMin(m_size, offset + limit) : m_size;
+
+    qint64 pos = offset;
+    for (int index = findPiece(pos); pos < end; ++index) {
+        const Piece &piece = m_pieces.at(index);
+        qint64 pieceOffset = pos - m_pieceStarts.at(index);
+        qint64 n = qMin(piece.length - pieceOffset, end - pos);
+        const char *data = pieceData(piece) + pieceOffset;
+
+        const void *hit = std::memchr(data, '\n', static_cast<size_t>(n));
+        if (hit)
+            return pos + (static_cast<const char *>(hit) - data) + 1;
+        pos += n;
+    }
+    return end;
+}
+
+qint64 PieceTable::previousLineStart(qint64 offset, qint64 limit) const
+{
+    qint64 start = lineStart(offset, limit);
+    if (start == 0)
+        return 0;
+
+    // Step over the newline ending the previous line, then find its start
+    return lineStart(start - 1, limit);
+}
+
+bool PieceTable::indexOriginal()
+{
+    if (isIndexed())
+        return true;
+
+    qint64 start = (m_originalCheckpoints.size() - 1) * IndexChunkSize;
+    qint64 end = qMin(start + IndexChunkSize, m_original.size());
+    m_originalCheckpoints.append(m_originalCheckpoints.last() + m_original.countNewlines(start, end));
+
+    for (Piece &piece : m_pieces) {
+        if (piece.newlines < 0)
+            piece.newlines = countNewlines(piece, 0, piece.length);
+    }
+
+    return isIndexed();
+}
+
+bool PieceTable::isIndexed() const
+{
+    return (m_originalCheckpoints.size() - 1) * IndexChunkSize >= m_original.size();
+}
+
+qint64 PieceTable::lineNumberAt(qint64 offset) const
+{
+    offset = qBound<qint64>(0, offset, m_size);
+    int index = findPiece(offset);
+
+    qint64 line = 0;
+    for (int i = 0; i < index; ++i) {
+        if (m_pieces.at(i).newlines < 0)
+            return -1;
+        line += m_pieces.at(i).newlines;
+    }
+
+    if (index < m_pieces.size()) {
+        qint64 partial = countNewlines(m_pieces.at(index), 0, offset - m_pieceStarts.at(index));
+        if (partial < 0)
+            return -1;
+        line += partial;
+    }
+    return line;
+}
+
+qint64 PieceTable::lineCount() const
+{
+    qint64 newlines = lineNumberAt(m_size);
+    if (newlines < 0 || m_size == 0)
+        return newlines;
+
+    bool trailingLine = text(m_size - 1, 1) != "\n";
+    return newlines + (trailingLine ? 1 : 0);
+}
@@ -0,0 +1,121 @@
+#ifndef PIECETABLE_H
+#define PIECETABLE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include "mappedfile.h"
+
+// Editable byte buffer over a memory-mapped file. The original bytes are
+// never copied or modified; inserted text is appended to a separate add
+// buffer and the document is described by a list of pieces pointing into
+// either buffer. Edits and undo only touch the pieces around the edit, so
+// their cost depends on the size of the edit and not on the document.
+class PieceTable
+{
+public:
+    PieceTable();
+    ~PieceTable();
+
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const { return m_original.isOpen(); }
+
+    // Unmaps the original without touching the pieces or the undo history,
+    // so the file can be replaced on disk. Nothing may be read until
+    // remapOriginal() has mapped it again; that fails, and closes the
+    // table, if the file no longer has the size it had when released.
+    void releaseOriginal();
+    bool remapOriginal();
+    QString fileName() const { return m_original.fileName(); }
+    QString errorString() const { return m_original.errorString(); }
+
+    qint64 size() const { return m_size; }
+    QByteArray text(qint64 pos, qint64 length) const;
+
+    void insert(qint64 pos, const QByteArray &bytes);
+    void remove(qint64 pos, qint64 length);
+
+    // Edits made between these calls undo as a single step
+    void beginGroup();
+    void endGroup();
+
+    // Undo and redo return the document position of the change, or -1
+    bool canUndo() const { return !m_undoStack.isEmpty(); }
+    bool canRedo() const { return !m_redoStack.isEmpty(); }
+    qint64 undo();
+    qint64 redo();
+
+    bool isModified() const { return m_savePoint != m_undoStack.size(); }
+
+    // Line navigation, see MappedFile. Offsets are byte offsets into the document.
+    qint64 lineStart(qint64 offset, qint64 limit = -1) const;
+    qint64 nextLineStart(qint64 offset, qint64 limit = -1) const;
+    qint64 previousLineStart(qint64 offset, qint64 limit = -1) const;
+
+    // Newline index of the original file, built incrementally by the caller
+    // so line numbers become available without a per-line index in memory.
+    // Returns true once the whole file is indexed.
+    bool indexOriginal();
+    bool isIndexed() const;
+
+    // Both return -1 while the part of the original they depend on is not indexed yet
+    qint64 lineNumberAt(qint64 offset) const;
+    qint64 lineCount() const;
+
+private:
+    enum Source { Original, Add };
+
+    struct Piece {
+        Source source;
+        qint64 start;
+        qint64 length;
+        qint64 newlines;    // -1 while unknown
+    };
+
+    // One replacement of a run of pieces; an edit is a group of these so
+    // that consecutive typing can be undone as a single step
+    struct Step {
+        int index;
+        QVector<Piece> removed;
+        QVector<Piece> inserted;
+    };
+
+    struct Edit {
+        QVector<Step> steps;
+        qint64 position;
+        qint64 end;
+        bool typing;
+    };
+
+    MappedFile m_original;
+    qint64 m_releasedSize;
+    QByteArray m_add;
+    QVector<Piece> m_pieces;
+    QVector<qint64> m_pieceStarts;
+    qint64 m_size;
+
+    QVector<Edit> m_undoStack;
+    QVector<Edit> m_redoStack;
+    int m_savePoint;
+    bool m_grouping;
+    bool m_groupOpen;
+
+    // Newline count before every IndexChunkSize bytes of the original
+    QVector<qint64> m_originalCheckpoints;
+
+    const char *pieceData(const Piece &piece) const;
+    int findPiece(qint64 pos) const;
+    Piece makePiece(Source source, qint64 start, qint64 length) const;
+    qint64 originalNewlinesBefore(qint64 offset) const;
+    qint64 countNewlines(const Piece &piece, qint64 from, qint64 to) const;
+    void applyStep(int index, const QVector<Piece> &removed, const QVector<Piece> &inserted);
+    void recordStep(const Step &step, qint64 position, qint64 end, bool typing);
+    void updatePieceStarts(int from);
+
+    static const qint64 IndexChunkSize = 4 * 1024 * 1024;
+
+    Q_DISABLE_COPY(PieceTable)
+};
+
+#endif // PIECETABLE_H
@@ -4,7 +4,10 @@
 #include "findreplacedialog.h"
 #include "gotolinedialog.h"
 #include "codeeditor.h"
+#include "hexview.h"
 #include <QTabWidget>
+#include <QInputDialog>
+#include <QMessageBox>
 
 SearchManager::SearchManager(MainWindow *parent)
     : QObject(parent), m_mainWindow(parent), m_findReplaceDialog(nullptr), m_goToLineDialog(nullptr)
@@ -32,6 +35,12 @@ void SearchManager::showFindReplaceDialog()
     if (!editor)
         return;
 
+    if (editor->hexViewer())
+    {
+        findBytes(editor->hexViewer());
+        return;
+    }
+
     if (!m_findReplaceDialog)
     {
         m_findReplaceDialog = new FindReplaceDialog(m_mainWindow);
@@ -49,6 +58,12 @@ void SearchManager::showGoToLineDialog()
     if (!editor)
         return;
 
+    if (editor->hexViewer())
+    {
+        goToOffset(editor->hexViewer());
+        return;
+    }
+
     if (!m_goToLineDialog)
     {
         m_goToLineDialog = new GoToLineDialog(m_mainWindow);
@@ -60,6 +75,48 @@ void SearchManager::showGoToLineDialog()
     m_goToLineDialog->activateWindow();
 }
 
+void SearchManager::findBytes(HexView *view)
+{
+    bool ok = false;
+    QString text = QInputDialog::getText(m_mainWindow, "Find Bytes",
+                                         "Hex bytes (e.g. 7F 45 4C 46) or quoted text:",
+                                         QLineEdit::Normal, m_lastBytePattern, &ok);
+    if (!ok || text.isEmpty())
+        return;
+
+    QByteArray pattern;
+    if (!HexView::parsePattern(text, &pattern))
+    {
+        QMessageBox::warning(m_mainWindow, "NotepadX", tr("\"%1\" is not a valid byte pattern.").arg(text));
+        return;
+    }
+
+    m_lastBytePattern = text;
+    if (!view->findNext(pattern))
+        QMessageBox::information(m_mainWindow, "Find Bytes", tr("The pattern was not found."));
+}
+
+void SearchManager::goToOffset(HexView *view)
+{
+    bool ok = false;
+    QString text = QInputDialog::getText(m_mainWindow, "Go to Offset",
+                                         "Offset (decimal, or hex with 0x):", QLineEdit::Normal,
+                                         QString("0x%1").arg(view->cursorOffset(), 0, 16), &ok);
+    if (!ok || text.isEmpty())
+        return;
+
+    QString number = text.trimmed();
+    bool hex = number.startsWith("0x", Qt::CaseInsensitive);
+    qint64 offset = (hex ? number.mid(2) : number).toLongLong(&ok, hex ? 16 : 10);
+    if (!ok || offset < 0 || offset >= view->fileSize())
+    {
+        QMessageBox::warning(m_mainWindow, "NotepadX",
+                             tr("The offset must be between 0 and %1.").arg(view->fileSize() - 1));
+        return;
+    }
+    view->goToOffset(offset);
+}
+
 EditorWidget *SearchManager::currentEditor()
 {
     QTabWidget *tabWidget = m_mainWindow->findChild<QTabWidget*>();
@@ -2,11 +2,13 @@
 #define SEARCHMANAGER_H
 
 #include <QObject>
+#include <QString>
 
 class MainWindow;
 class EditorWidget;
 class FindReplaceDialog;
 class GoToLineDialog;
+class HexView;
 
 class SearchManager : public QObject
 {
@@ -24,6 +26,11 @@ private:
     MainWindow *m_mainWindow;
     FindReplaceDialog *m_findReplaceDialog;
     GoToLineDialog *m_goToLineDialog;
+    QString m_lastBytePattern;
+
+    // Hex view counterparts of the text dialogs
+    void findBytes(HexView *view);
+    void goToOffset(HexView *view);
 
     // Helper to get current editor
     EditorWidget *currentEditor();
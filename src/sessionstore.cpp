@@ -0,0 +1,562 @@
+#include "sessionstore.h"
+#include "editorwidget.h"
+#include "codeeditor.h"
+#include <QTabWidget>
+#include <QTextDocument>
+#include <QTextCursor>
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QSet>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QStandardPaths>
+#include <QUuid>
+#include <QDebug>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+const quint32 IndexMagic = 0x4e585353; // "NXSS"
+const quint32 IndexVersion = 1;
+const char BlobSuffix[] = ".blob";
+const char JournalSuffix[] = ".wal";
+
+// Each journal record is framed by its payload size and a checksum, so a
+// record torn by a crash ends the replay instead of corrupting the text
+const int RecordHeaderSize = 6;
+
+// Smallest serialized tab in the index: three empty strings, a bool and
+// two ints. A tab count that cannot fit in the file marks it as corrupt.
+const qint64 MinTabSize = 3 * 4 + 1 + 2 * 4;
+
+QString journalFor(const QString &blobPath)
+{
+    QString path = blobPath;
+    path.chop(int(sizeof(BlobSuffix)) - 1);
+    return path + QLatin1String(JournalSuffix);
+}
+
+quint16 checksum(const QByteArray &data)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return qChecksum(QByteArrayView(data));
+#else
+    return qChecksum(data.constData(), static_cast<uint>(data.size()));
+#endif
+}
+
+bool syncToDisk(QFileDevice &file)
+{
+#ifdef Q_OS_WIN
+    HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(file.handle()));
+    return handle != INVALID_HANDLE_VALUE && FlushFileBuffers(handle);
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+bool writeAtomically(const QString &path, const QByteArray &data)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qWarning("SessionStore: cannot write %s: %s", qPrintable(path), qPrintable(file.errorString()));
+        return false;
+    }
+    return true;
+}
+
+bool appendDurably(const QString &path, const QByteArray &data)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append) || file.write(data) != data.size()
+        || !file.flush() || !syncToDisk(file)) {
+        qWarning("SessionStore: cannot append to %s: %s", qPrintable(path), qPrintable(file.errorString()));
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+// Does all session I/O in the order it was queued: journal appends, blob
+// snapshots, each of which drops the journal it covers once it is safely
+// written, and the index that refers to them.
+class SessionWriter : public QThread
+{
+public:
+    explicit SessionWriter(QObject *parent)
+        : QThread(parent), m_busy(false), m_stopping(false)
+    {
+    }
+
+    ~SessionWriter()
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_stopping = true;
+            m_jobAdded.wakeAll();
+        }
+        wait();
+    }
+
+    void appendJournal(const QString &path, const QByteArray &records)
+    {
+        Job job;
+        job.kind = Job::Journal;
+        job.path = path;
+        job.data = records;
+        enqueue(job);
+    }
+
+    void writeBlob(const QString &path, const QString &text)
+    {
+        Job job;
+        job.kind = Job::Blob;
+        job.path = path;
+        job.text = text;
+        enqueue(job);
+    }
+
+    // Blobs and journals in the index directory that are not listed are
+    // removed after the index is written
+    void writeIndex(const QString &path, const QByteArray &data, const QStringList &blobs)
+    {
+        Job job;
+        job.kind = Job::Index;
+        job.path = path;
+        job.data = data;
+        job.blobs = blobs;
+        enqueue(job);
+    }
+
+    void waitForIdle()
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_busy || !m_jobs.isEmpty())
+            m_idle.wait(&m_mutex);
+    }
+
+protected:
+    void run() override
+    {
+        forever {
+            Job job;
+            {
+                QMutexLocker locker(&m_mutex);
+                m_busy = false;
+                if (m_jobs.isEmpty())
+                    m_idle.wakeAll();
+                while (m_jobs.isEmpty() && !m_stopping)
+                    m_jobAdded.wait(&m_mutex);
+                if (m_jobs.isEmpty())
+                    return;
+                job = m_jobs.dequeue();
+                m_busy = true;
+            }
+
+            switch (job.kind) {
+            case Job::Journal:
+                appendDurably(job.path, job.data);
+                break;
+            case Job::Blob:
+                if (writeAtomically(job.path, qCompress(job.text.toUtf8())))
+                    QFile::remove(journalFor(job.path));
+                break;
+            case Job::Index:
+                if (writeAtomically(job.path, job.data))
+                    removeUnreferenced(QFileInfo(job.path).dir(), job.blobs);
+                break;
+            }
+        }
+    }
+
+private:
+    struct Job {
+        enum Kind { Journal, Blob, Index };
+        Kind kind;
+        QString path;
+        QString text;
+        QByteArray data;
+        QStringList blobs;
+    };
+
+    void enqueue(const Job &job)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_jobs.enqueue(job);
+        m_jobAdded.wakeAll();
+    }
+
+    static void removeUnreferenced(QDir directory, const QStringList &blobs)
+    {
+        QStringList filters;
+        filters << QLatin1Char('*') + QLatin1String(BlobSuffix) << QLatin1Char('*') + QLatin1String(JournalSuffix);
+        const QStringList existing = directory.entryList(filters, QDir::Files);
+        for (const QString &name : existing) {
+            if (!blobs.contains(QFileInfo(name).completeBaseName() + QLatin1String(BlobSuffix)))
+                directory.remove(name);
+        }
+    }
+
+    QMutex m_mutex;
+    QWaitCondition m_jobAdded;
+    QWaitCondition m_idle;
+    QQueue<Job> m_jobs;
+    bool m_busy;
+    bool m_stopping;
+};
+
+SessionStore::SessionStore(QTabWidget *tabWidget, QObject *parent)
+    : QObject(parent), m_tabWidget(tabWidget), m_writer(new SessionWriter(this))
+{
+    m_directory = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+                  + QLatin1String("/session");
+    QDir().mkpath(m_directory);
+
+    // Typing restarts the timer, so a burst of edits costs one write
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(SaveDelayMs);
+    connect(&m_saveTimer, &QTimer::timeout, this, &SessionStore::saveInBackground);
+
+    // Not restarted by typing, so records reach the disk on time
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(JournalFlushMs);
+    connect(&m_flushTimer, &QTimer::timeout, this, &SessionStore::flushJournals);
+
+    m_writer->start(QThread::LowPriority);
+}
+
+SessionStore::~SessionStore()
+{
+}
+
+QString SessionStore::indexPath() const
+{
+    return m_directory + QLatin1String("/session.idx");
+}
+
+QString SessionStore::blobPath(const QString &blob) const
+{
+    return m_directory + QLatin1Char('/') + blob;
+}
+
+bool SessionStore::read(QVector<Tab> *tabs, int *activeTab) const
+{
+    QVector<Tab> result;
+    qint32 active = 0;
+    bool indexRead = false;
+
+    QFile file(indexPath());
+    if (file.open(QIODevice::ReadOnly)) {
+        QDataStream in(&file);
+        in.setVersion(QDataStream::Qt_5_0);
+        quint32 magic = 0;
+        quint32 version = 0;
+        qint32 count = 0;
+        in >> magic >> version >> active >> count;
+        if (magic == IndexMagic && version == IndexVersion && count >= 0
+            && count <= (file.size() - file.pos()) / MinTabSize) {
+            for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+                Tab tab;
+                qint32 zoomLevel = 0;
+                qint32 cursorPosition = 0;
+                in >> tab.filePath >> tab.untitled >> tab.language >> zoomLevel >> cursorPosition >> tab.blob;
+                tab.zoomLevel = zoomLevel;
+                tab.cursorPosition = cursorPosition;
+                if (!tab.blob.isEmpty())
+                    tab.blob = blobPath(tab.blob);
+                result.append(tab);
+            }
+            indexRead = in.status() == QDataStream::Ok;
+        }
+        if (!indexRead)
+            result.clear();
+    }
+
+    // A tab created and typed into shortly before a crash may only have
+    // made it into its journal
+    QSet<QString> known;
+    for (const Tab &tab : result)
+        known.insert(tab.blob);
+    const QStringList journals = QDir(m_directory).entryList(
+        QStringList(QLatin1Char('*') + QLatin1String(JournalSuffix)), QDir::Files, QDir::Time | QDir::Reversed);
+    for (const QString &journal : journals) {
+        QString blob = blobPath(QFileInfo(journal).completeBaseName() + QLatin1String(BlobSuffix));
+        if (known.contains(blob))
+            continue;
+        Tab tab;
+        tab.untitled = true;
+        tab.zoomLevel = 0;
+        tab.cursorPosition = 0;
+        tab.blob = blob;
+        result.append(tab);
+    }
+
+    if (!indexRead && result.isEmpty())
+        return false;
+    *tabs = result;
+    *activeTab = active;
+    return true;
+}
+
+QString SessionStore::readBuffer(const QString &blob, bool *replayed)
+{
+    // Mapped rather than read, the pages are dropped again right after
+    // the text is decompressed
+    QString text;
+    QFile file(blob);
+    if (file.open(QIODevice::ReadOnly) && file.size() > 0) {
+        uchar *data = file.map(0, file.size());
+        if (data) {
+            text = QString::fromUtf8(qUncompress(data, static_cast<int>(file.size())));
+            file.unmap(data);
+        } else {
+            text = QString::fromUtf8(qUncompress(file.readAll()));
+        }
+    }
+
+    *replayed = false;
+    QFile journal(journalFor(blob));
+    if (!journal.open(QIODevice::ReadOnly))
+        return text;
+    const QByteArray records = journal.readAll();
+    int offset = 0;
+    while (records.size() - offset >= RecordHeaderSize) {
+        QDataStream header(records.mid(offset, RecordHeaderSize));
+        quint32 size = 0;
+        quint16 sum = 0;
+        header >> size >> sum;
+        if (size > static_cast<quint32>(records.size() - offset - RecordHeaderSize))
+            break;
+        const QByteArray payload = records.mid(offset + RecordHeaderSize, static_cast<int>(size));
+        if (checksum(payload) != sum)
+            break;
+        offset += RecordHeaderSize + static_cast<int>(size);
+
+        QDataStream in(payload);
+        in.setVersion(QDataStream::Qt_5_0);
+        qint32 position = 0;
+        qint32 removed = 0;
+        QString added;
+        in >> position >> removed >> added;
+        if (in.status() != QDataStream::Ok)
+            break;
+
+        // The document reports changes that touch its implicit last
+        // paragraph separator one character too long
+        position = qBound(0, position, static_cast<int>(text.size()));
+        removed = qBound(0, removed, static_cast<int>(text.size()) - position);
+        text.replace(position, removed, added);
+        *replayed = true;
+    }
+    return text;
+}
+
+void SessionStore::track(EditorWidget *editor)
+{
+    // The name is picked up front so the journal can start right away
+    TabState state;
+    state.blob = QUuid::createUuid().toString().mid(1, 36) + QLatin1String(BlobSuffix);
+    state.revision = -1;
+    state.journalSize = 0;
+    state.replayable = true;
+    m_states.insert(editor, state);
+
+    QTextDocument *document = editor->editor()->document();
+    connect(document, &QTextDocument::contentsChanged, this, &SessionStore::scheduleSave);
+    connect(document, &QTextDocument::contentsChange, this, [this, editor](int position, int removed, int added) {
+        record(editor, position, removed, added);
+    });
+    connect(editor, &QObject::destroyed, this, [this, editor]() {
+        m_states.remove(editor);
+        scheduleSave();
+    });
+
+    // A buffer that now has a file comes back from there; its journal is
+    // dropped, and one already on disk goes with the next index
+    connect(editor, &EditorWidget::fileNameChanged, this, [this, editor](const QString &fileName) {
+        if (fileName.isEmpty() || !m_states.contains(editor))
+            return;
+        TabState &state = m_states[editor];
+        state.journal.clear();
+        if (state.journalSize > 0) {
+            state.journalSize = 0;
+            save(false);
+        }
+    });
+}
+
+void SessionStore::restored(EditorWidget *editor, const QString &blob)
+{
+    // Keep writing to the blob the tab came from, under its bare name
+    TabState &state = m_states[editor];
+    state.blob = QFileInfo(blob).fileName();
+    state.revision = CleanRevision;
+}
+
+void SessionStore::loadInto(EditorWidget *editor, const QString &blob)
+{
+    bool replayed = false;
+    QString text = readBuffer(blob, &replayed);
+
+    editor->fillDocument(text);
+
+    // After a replay the blob is stale, and any journal left behind may end
+    // in a torn record that new ones can't follow, so the next save
+    // compacts it into a fresh snapshot
+    TabState &state = m_states[editor];
+    state.replayable = !replayed && !QFile::exists(journalFor(blob));
+    if (!state.replayable) {
+        state.revision = CleanRevision;
+        scheduleSave();
+    } else {
+        state.revision = editor->editor()->document()->revision();
+    }
+}
+
+void SessionStore::record(EditorWidget *editor, int position, int removed, int added)
+{
+    // Only untitled buffers have nowhere else to come back from
+    if (!editor->currentFile().isEmpty())
+        return;
+
+    // What a blob or the legacy settings bring into the document is not
+    // typing; the journal can't replay it, so the next save snapshots it
+    if (editor->isFillingDocument() || editor->isPending() || editor->isLoading()) {
+        auto it = m_states.find(editor);
+        if (it != m_states.end())
+            it.value().replayable = false;
+        return;
+    }
+
+    // Usually a single character, so typing pays for a cursor lookup and a
+    // few bytes; the disk is only touched by the writer
+    QString text;
+    QTextDocument *document = editor->editor()->document();
+    if (added > 0) {
+        QTextCursor cursor(document);
+        cursor.setPosition(position);
+        cursor.setPosition(qMin(position + added, document->characterCount() - 1), QTextCursor::KeepAnchor);
+        text = cursor.selectedText();
+        text.replace(QChar::ParagraphSeparator, QLatin1Char('\n'));
+        text.replace(QChar::LineSeparator, QLatin1Char('\n'));
+        text.replace(QChar::Nbsp, QLatin1Char(' '));
+    }
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << qint32(position) << qint32(removed) << text;
+
+    TabState &state = m_states[editor];
+    QDataStream header(&state.journal, QIODevice::Append);
+    header << quint32(payload.size()) << checksum(payload);
+    state.journal.append(payload);
+
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+}
+
+void SessionStore::flushJournals()
+{
+    bool compact = false;
+    for (auto it = m_states.begin(); it != m_states.end(); ++it) {
+        TabState &state = it.value();
+        if (state.journal.isEmpty())
+            continue;
+        m_writer->appendJournal(journalFor(blobPath(state.blob)), state.journal);
+        state.journalSize += state.journal.size();
+        state.journal.clear();
+        if (state.journalSize > CompactJournalBytes)
+            compact = true;
+    }
+
+    // Steady typing keeps restarting the save timer, so a long journal
+    // is compacted from here instead
+    if (compact)
+        save(false);
+}
+
+void SessionStore::scheduleSave()
+{
+    m_saveTimer.start();
+}
+
+void SessionStore::saveInBackground()
+{
+    save(false);
+}
+
+void SessionStore::save(bool wait)
+{
+    m_saveTimer.stop();
+
+    QVector<EditorWidget *> editors;
+    for (int i = 0; i < m_tabWidget->count(); ++i) {
+        EditorWidget *editor = qobject_cast<EditorWidget *>(m_tabWidget->widget(i));
+        if (editor)
+            editors.append(editor);
+    }
+
+    QByteArray index;
+    QDataStream out(&index, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << IndexMagic << IndexVersion << qint32(m_tabWidget->currentIndex()) << qint32(editors.size());
+
+    QStringList blobs;
+    for (EditorWidget *editor : editors) {
+        QString filePath = editor->currentFile();
+        bool untitled = filePath.isEmpty();
+        QString blob;
+        if (untitled) {
+            TabState &state = m_states[editor];
+            blob = state.blob;
+            blobs.append(blob);
+
+            // A tab that was never activated still has its text in the
+            // blob it was restored from, unless it came from the settings
+            bool dirty;
+            if (editor->isPending()) {
+                dirty = state.revision != CleanRevision;
+            } else {
+                dirty = state.revision != editor->editor()->document()->revision();
+            }
+            // Copying the whole document is not worth it on every pause,
+            // the journal already holds the typing since the last snapshot
+            bool snapshot = dirty && (editor->isPending() || !state.replayable
+                                      || state.journalSize + state.journal.size() > CompactJournalBytes);
+            if (snapshot) {
+                // The snapshot covers every record so far and removes
+                // the journal once it is written
+                m_writer->writeBlob(blobPath(blob), editor->text());
+                state.journal.clear();
+                state.journalSize = 0;
+                state.replayable = true;
+                state.revision = editor->isPending() ? static_cast<int>(CleanRevision)
+                                                     : editor->editor()->document()->revision();
+            } else if (!state.journal.isEmpty()) {
+                m_writer->appendJournal(journalFor(blobPath(blob)), state.journal);
+                state.journalSize += state.journal.size();
+                state.journal.clear();
+            }
+        }
+        out << filePath << untitled << editor->currentLanguage()
+            << qint32(editor->getCurrentZoomLevel()) << qint32(editor->cursorPosition()) << blob;
+    }
+
+    m_writer->writeIndex(indexPath(), index, blobs);
+    if (wait)
+        m_writer->waitForIdle();
+}
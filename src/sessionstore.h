@@ -0,0 +1,90 @@
+#ifndef SESSIONSTORE_H
+#define SESSIONSTORE_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QTimer>
+
+class QTabWidget;
+class EditorWidget;
+class SessionWriter;
+
+// Keeps the open tabs in a small binary index next to one compressed blob
+// per untitled buffer, instead of the settings file. All I/O happens on a
+// worker thread, so by the time the window closes there is usually nothing
+// left to write but the index.
+//
+// Every edit to an untitled buffer is appended to a journal next to its
+// blob and synced to disk about once a second, so a crash loses at most
+// that much typing. Blob plus journal is the buffer; a new snapshot is only
+// taken once the journal has grown large, or when text reached the buffer
+// without going through the journal. Writing a snapshot discards the
+// journal it covers.
+class SessionStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Tab {
+        QString filePath;
+        bool untitled;
+        QString language;
+        int zoomLevel;
+        int cursorPosition;
+        QString blob;   // untitled contents, empty if none
+        QString text;   // only set when read from the legacy settings
+    };
+
+    explicit SessionStore(QTabWidget *tabWidget, QObject *parent = nullptr);
+    ~SessionStore();
+
+    // Reads the index; false if there is no usable session. Journals of
+    // tabs the index does not know about yet come back as untitled tabs.
+    bool read(QVector<Tab> *tabs, int *activeTab) const;
+
+    // Every editor is tracked from creation. A restored tab still backed by
+    // its blob is clean until it is edited.
+    void track(EditorWidget *editor);
+    void restored(EditorWidget *editor, const QString &blob);
+
+    // Fills a restored untitled tab from its blob and replays its journal
+    void loadInto(EditorWidget *editor, const QString &blob);
+
+    // Queues dirty blobs and the index; wait blocks until all is on disk
+    void save(bool wait);
+
+private slots:
+    void scheduleSave();
+    void saveInBackground();
+    void flushJournals();
+
+private:
+    struct TabState {
+        QString blob;
+        int revision;
+        QByteArray journal;     // records not handed to the writer yet
+        qint64 journalSize;     // bytes written since the last snapshot
+        bool replayable;        // blob and journal rebuild the document
+    };
+
+    QString indexPath() const;
+    QString blobPath(const QString &blob) const;
+    void record(EditorWidget *editor, int position, int removed, int added);
+    static QString readBuffer(const QString &blob, bool *replayed);
+
+    QTabWidget *m_tabWidget;
+    QString m_directory;
+    QHash<EditorWidget *, TabState> m_states;
+    QTimer m_saveTimer;
+    QTimer m_flushTimer;
+    SessionWriter *m_writer;
+
+    static const int SaveDelayMs = 2000;
+    static const int JournalFlushMs = 1000;
+    static const int CompactJournalBytes = 1024 * 1024;
+    static const int CleanRevision = -2;
+};
+
+#endif // SESSIONSTORE_H
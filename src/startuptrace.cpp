@@ -0,0 +1,66 @@
+#include "startuptrace.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QDebug>
+#include <iostream>
+
+namespace {
+
+QElapsedTimer &startupClock()
+{
+    static QElapsedTimer timer;
+    return timer;
+}
+
+QFile &crashLog()
+{
+    static QFile file(QStringLiteral("crash_log.txt"));
+    return file;
+}
+
+bool tracing = false;
+qint64 lastMark = 0;
+
+} // namespace
+
+void StartupTrace::begin(bool enabled)
+{
+    startupClock().start();
+    tracing = enabled;
+    lastMark = 0;
+
+    // Flushed after every line, so it survives a crash without reopening
+    crashLog().open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text);
+}
+
+bool StartupTrace::isEnabled()
+{
+    return tracing;
+}
+
+void StartupTrace::log(const QString &message)
+{
+    qDebug() << message;
+    QFile &file = crashLog();
+    if (file.isOpen()) {
+        file.write(message.toUtf8());
+        file.write("\n");
+        file.flush();
+    }
+}
+
+void StartupTrace::mark(const char *phase)
+{
+    if (!tracing)
+        return;
+
+    qint64 now = startupClock().nsecsElapsed() / 1000;
+    QString line = QString("startup: %1 ms (+%2 ms) %3")
+                       .arg(now / 1000.0, 8, 'f', 1)
+                       .arg((now - lastMark) / 1000.0, 6, 'f', 1)
+                       .arg(QLatin1String(phase));
+    lastMark = now;
+    std::cerr << line.toStdString() << std::endl;
+    log(line);
+}
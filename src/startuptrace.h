@@ -0,0 +1,22 @@
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include <QString>
+
+// Startup diagnostics. The crash log is opened once and kept open instead
+// of being reopened for every line, and with --startup-trace each phase of
+// startup is timed from the start of main() and reported on stderr.
+class StartupTrace
+{
+public:
+    static void begin(bool enabled);
+    static bool isEnabled();
+
+    // Appends a line to the crash log
+    static void log(const QString &message);
+
+    // Records that a phase has finished; free when tracing is off
+    static void mark(const char *phase);
+};
+
+#endif // STARTUPTRACE_H
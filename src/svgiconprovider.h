@@ -6,11 +6,16 @@
 #include <QDebug>
 #include <QFile>
 #include <QDir>
+#include <QFileInfo>
 #include <QCoreApplication>
 #include <QApplication>
 #include <QPalette>
 #include <QSvgRenderer>
 #include <QPainter>
+#include <QPixmapCache>
+#include <QStandardPaths>
+#include <QHash>
+#include <QStringList>
 
 class SvgIconProvider
 {
@@ -18,66 +23,174 @@ public:
     // Get SVG icon by name
     static QIcon getIcon(const QString &iconName)
     {
-        // Try to load SVG from resources or local path
-        QString svgContent;
-        QString iconPath = QString(":/icons/%1.svg").arg(iconName);
-        
-        if (!loadSvgContent(iconPath, svgContent)) {
-            // Try local path
-            QString localPath = QDir(QCoreApplication::applicationDirPath()).filePath(
-                QString("icons/%1.svg").arg(iconName));
-            
-            if (!loadSvgContent(localPath, svgContent)) {
-                qDebug() << "SVG icon not found:" << iconName;
-                return QIcon();
-            }
+        QPixmap lightThemePixmap = cachedPixmap(iconName, QColor(40, 40, 40));
+        if (lightThemePixmap.isNull()) {
+            qDebug() << "SVG icon not found:" << iconName;
+            return QIcon();
         }
         
         // Create pixmaps for different theme states
         QIcon icon;
         
         // For light theme - use dark color
-        QPixmap lightThemePixmap = createColoredPixmap(svgContent, QColor(40, 40, 40));
         icon.addPixmap(lightThemePixmap, QIcon::Normal, QIcon::Off);
         
         // For dark theme - use light color
-        QPixmap darkThemePixmap = createColoredPixmap(svgContent, QColor(220, 220, 220));
-        icon.addPixmap(darkThemePixmap, QIcon::Normal, QIcon::On);
+        icon.addPixmap(cachedPixmap(iconName, QColor(220, 220, 220)), QIcon::Normal, QIcon::On);
         
         // Create disabled state pixmaps
-        QPixmap lightDisabledPixmap = createColoredPixmap(svgContent, QColor(150, 150, 150));
-        icon.addPixmap(lightDisabledPixmap, QIcon::Disabled, QIcon::Off);
+        icon.addPixmap(cachedPixmap(iconName, QColor(150, 150, 150)), QIcon::Disabled, QIcon::Off);
+        icon.addPixmap(cachedPixmap(iconName, QColor(120, 120, 120)), QIcon::Disabled, QIcon::On);
         
-        QPixmap darkDisabledPixmap = createColoredPixmap(svgContent, QColor(120, 120, 120));
-        icon.addPixmap(darkDisabledPixmap, QIcon::Disabled, QIcon::On);
+        return icon;
+    }
+    
+    // Icon colored for one theme, as the toolbar shows it. Null if there is
+    // no SVG of that name.
+    static QIcon themedIcon(const QString &iconName, bool dark)
+    {
+        QPixmap normalPixmap = cachedPixmap(iconName, dark ? QColor(255, 255, 255) : QColor(50, 50, 50));
+        if (normalPixmap.isNull()) {
+            return QIcon();
+        }
         
+        QIcon icon;
+        icon.addPixmap(normalPixmap, QIcon::Normal);
+        icon.addPixmap(cachedPixmap(iconName, dark ? QColor(120, 120, 120) : QColor(150, 150, 150)), QIcon::Disabled);
         return icon;
     }
+    
+    // Renders every pixmap the icons need in either theme, so switching
+    // themes later only takes cache hits
+    static void prewarm(const QStringList &iconNames)
+    {
+        for (const QString &iconName : iconNames) {
+            getIcon(iconName);
+            themedIcon(iconName, false);
+            themedIcon(iconName, true);
+        }
+    }
 
 private:
+    // Rendered pixmaps are kept in QPixmapCache and as PNGs in the cache
+    // directory. The key covers everything the pixmap depends on, the SVG
+    // itself included, so an edited icon is never served stale.
+    static QPixmap cachedPixmap(const QString &iconName, const QColor &color, int size = 24)
+    {
+        const QByteArray svgContent = svgData(iconName);
+        if (svgContent.isEmpty()) {
+            return QPixmap();
+        }
+        
+        const qreal ratio = qApp->devicePixelRatio();
+        const QString key = QString("%1-%2-%3-%4@%5")
+                                .arg(iconName)
+                                .arg(quint64(qHash(svgContent)), 0, 16)
+                                .arg(color.name().mid(1))
+                                .arg(size)
+                                .arg(ratio);
+        
+        QPixmap pixmap;
+        if (QPixmapCache::find(key, &pixmap)) {
+            return pixmap;
+        }
+        
+        const QString diskPath = cacheDirectory() + "/" + key + ".png";
+        if (!pixmap.load(diskPath, "PNG")) {
+            pixmap = createColoredPixmap(svgContent, color, size, ratio);
+            pruneCacheDirectory();
+            pixmap.save(diskPath, "PNG");
+        }
+        pixmap.setDevicePixelRatio(ratio);
+        
+        QPixmapCache::insert(key, pixmap);
+        return pixmap;
+    }
+    
+    static QString cacheDirectory()
+    {
+        static const QString directory = []() {
+            QString path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/icons";
+            QDir().mkpath(path);
+            return path;
+        }();
+        return directory;
+    }
+    
+    // Pixmaps of edited icons or other screen scales are never looked up
+    // again, so once per run, before the first write, the oldest files go
+    // until the directory is back within its budget
+    static void pruneCacheDirectory()
+    {
+        static bool pruned = false;
+        if (pruned) {
+            return;
+        }
+        pruned = true;
+        
+        const QFileInfoList files = QDir(cacheDirectory()).entryInfoList(
+            QStringList("*.png"), QDir::Files, QDir::Time | QDir::Reversed);
+        qint64 total = 0;
+        for (const QFileInfo &info : files) {
+            total += info.size();
+        }
+        for (const QFileInfo &info : files) {
+            if (total <= MaxCacheBytes) {
+                break;
+            }
+            total -= info.size();
+            QFile::remove(info.filePath());
+        }
+    }
+    
+    static const qint64 MaxCacheBytes = 4 * 1024 * 1024;
+    
+    // SVG text by icon name; an empty entry remembers a missing icon
+    static QByteArray svgData(const QString &iconName)
+    {
+        static QHash<QString, QByteArray> svgCache;
+        auto it = svgCache.constFind(iconName);
+        if (it != svgCache.constEnd()) {
+            return it.value();
+        }
+        
+        // Try to load SVG from resources or local path
+        QByteArray content;
+        QString iconPath = QString(":/icons/%1.svg").arg(iconName);
+        if (!loadSvgContent(iconPath, content)) {
+            // Try local path
+            QString localPath = QDir(QCoreApplication::applicationDirPath()).filePath(
+                QString("icons/%1.svg").arg(iconName));
+            loadSvgContent(localPath, content);
+        }
+        
+        svgCache.insert(iconName, content);
+        return content;
+    }
+    
     // Load SVG content from file
-    static bool loadSvgContent(const QString &path, QString &content)
+    static bool loadSvgContent(const QString &path, QByteArray &content)
     {
         QFile file(path);
         if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
             return false;
         }
         
-        content = QString::fromUtf8(file.readAll());
+        content = file.readAll();
         file.close();
         return true;
     }
     
     // Create colored pixmap from SVG content
-    static QPixmap createColoredPixmap(const QString &svgContent, const QColor &color)
+    static QPixmap createColoredPixmap(const QByteArray &svgContent, const QColor &color, int size, qreal ratio)
     {
         // Prepare SVG content with color
-        QString coloredSvg = svgContent;
-        coloredSvg.replace("currentColor", color.name());
+        QByteArray coloredSvg = svgContent;
+        coloredSvg.replace("currentColor", color.name().toLatin1());
         
-        // Render SVG to pixmap
-        QSvgRenderer renderer(coloredSvg.toUtf8());
-        QPixmap pixmap(24, 24);
+        // Render SVG to pixmap at device resolution
+        QSvgRenderer renderer(coloredSvg);
+        QPixmap pixmap(QSize(size, size) * ratio);
         pixmap.fill(Qt::transparent);
         
         QPainter painter(&pixmap);